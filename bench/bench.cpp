@@ -0,0 +1,847 @@
+#include <daclifycore.hpp>
+#include "chain_sim.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+
+/**
+ * Native benchmark suite for daclifycore.
+ *
+ * Every ACTION is executed against chain_sim with a seeded group of realistic size.
+ * Only the measured call is counted, setup actions are excluded.
+ *
+ * usage: daclifycore_bench [iterations]
+ */
+
+namespace {
+
+  const uint32_t NUM_CUSTODIANS = 15;
+  const uint32_t NUM_MEMBERS = 1000;
+  const uint32_t NUM_PROPOSALS = 100;
+  const uint32_t NUM_THRESHOLDS = 10;
+  const uint32_t DEFAULT_THRESHOLD = NUM_CUSTODIANS * 4 / 5;//80% of the council
+  const uint32_t UPGRADE_BATCH = 5;//open proposals converted per upgrade call
+  const uint64_t START_TIME_US = 1767225600ULL * 1000000ULL;
+
+  const name GROUP = name("benchgroup11");
+  const name TOKEN = name("eosio.token");
+  const name HUB = name("daclifyhub11");
+  const name ELECTIONS = name("elections111");
+  const name PAYROLL = name("payroll11111");
+  const name HOOKS = name("hooks1111111");
+  const symbol SYS = symbol(symbol_code("EOS"), 4);
+
+  /**
+   * Generates a deterministic valid account name like `cust.aaaab`.
+   */
+  name make_account(const string& prefix, uint32_t i){
+    string suffix;
+    for(int d = 0; d < 6; d++){
+      suffix = char('a' + i % 26) + suffix;
+      i /= 26;
+    }
+    return name(prefix + "." + suffix);
+  }
+
+  name custodian(uint32_t i){ return make_account("cust", i); }
+  name member(uint32_t i){ return make_account("memb", i); }
+
+  struct result{
+    string label;
+    uint32_t calls = 0;
+    double total_us = 0;
+    chain_sim::counters totals;
+  };
+
+  //layout of the core's corestate row
+  struct corestate_row {
+    daclifycore::groupstate state;
+    binary_extension<daclifycore::groupstateext> ext;
+  };
+
+  //leading fields of the core's custodians row
+  struct custodian_row {
+    name account;
+    name authority;
+    uint8_t weight;
+    time_point_sec joined;
+    time_point_sec last_active;
+    time_point_sec inactive_after;
+    uint8_t slot;
+    uint64_t primary_key() const { return account.value; }
+  };
+
+  //layout of the custodians row of the first release
+  struct legacy_custodian_row {
+    name account;
+    name authority;
+    uint8_t weight;
+    time_point_sec joined;
+    time_point_sec last_active;
+    uint64_t primary_key() const { return account.value; }
+    uint64_t by_last_active() const { return last_active.sec_since_epoch(); }
+  };
+
+  //layout of the proposals row of the first release
+  struct legacy_proposal_row {
+    uint64_t id;
+    string title;
+    string description;
+    name proposer;
+    vector<action> actions;
+    time_point_sec submitted;
+    time_point_sec expiration;
+    vector<name> approvals;
+    name required_threshold;
+    name last_actor;
+    checksum256 trx_id;
+    uint64_t primary_key() const { return id; }
+    uint64_t by_threshold() const { return required_threshold.value; }
+    uint64_t by_proposer() const { return proposer.value; }
+    uint64_t by_expiration() const { return expiration.sec_since_epoch(); }
+  };
+
+  //leading fields of the core's proposals row
+  struct proposal_row {
+    uint64_t id;
+    name proposer;
+    time_point_sec submitted;
+    time_point_sec expiration;
+    uint64_t approvals;
+    name required_threshold;
+    name last_actor;
+    uint8_t approved_weight;
+    uint64_t primary_key() const { return id; }
+  };
+
+  //leading fields of the core's proparchive row
+  struct archive_row {
+    uint64_t id;
+    uint64_t proposal_id;
+    name proposer;
+    name outcome;
+    uint64_t primary_key() const { return id; }
+  };
+
+  //layout of the core's tokenbals and legacy balances rows
+  struct balance_row {
+    uint64_t key;
+    extended_asset balance;
+    uint64_t primary_key() const { return key; }
+  };
+
+  /**
+   * Stops the run when the tables don't hold what the benchmarked actions should have left.
+   */
+  void expect(bool condition, const string& what){
+    if(!condition){
+      fprintf(stderr, "bench check failed: %s\n", what.c_str() );
+      exit(1);
+    }
+  }
+
+  class world {
+    public:
+      chain_sim& sim = chain_sim::get();
+      vector<result> results;
+      vector<name> hooked_actions;
+      daclifycore::groupconf conf;
+
+      /**
+       * Executes a single action on a fresh contract instance.
+       *
+       * @param signers The accounts that authorize the action.
+       * @param fn The action call.
+       * @param first_receiver The first receiver, only differs from GROUP for notifications.
+       * @param r If set, the call is measured and added to this result.
+       */
+      void call(const vector<name>& signers, const std::function<void(daclifycore&)>& fn, name first_receiver = GROUP, result* r = nullptr){
+        vector<uint64_t> auths;
+        for(name s : signers){
+          auths.push_back(s.value);
+        }
+        sim.begin_action(GROUP.value, auths);
+        auto start = std::chrono::steady_clock::now();
+        {
+          daclifycore contract(GROUP, first_receiver, datastream<const char*>(nullptr, 0) );
+          fn(contract);
+        }
+        auto stop = std::chrono::steady_clock::now();
+        if(r != nullptr){
+          r->calls++;
+          r->total_us += std::chrono::duration<double, std::micro>(stop - start).count();
+          r->totals += sim.stats;
+        }
+      }
+
+      /**
+       * Measures `fn(i)` for i in [0, iterations) on a freshly seeded group.
+       */
+      void bench(const string& label, uint32_t iterations, const std::function<void(world&)>& setup, const std::function<void(world&, uint32_t, result*)>& fn){
+        seed();
+        setup(*this);
+        result r;
+        r.label = label;
+        for(uint32_t i = 0; i < iterations; i++){
+          fn(*this, i, &r);
+        }
+        results.push_back(r);
+      }
+
+      void advance(uint32_t sec){
+        sim.now_us += uint64_t(sec) * 1000000;
+      }
+
+      time_point_sec now(){
+        return time_point_sec(uint32_t(sim.now_us / 1000000) );
+      }
+
+      action transfer_action(name to, int64_t amount){
+        return action(
+          permission_level(GROUP, name("active") ),
+          TOKEN, name("transfer"),
+          std::make_tuple(GROUP, to, asset(amount, SYS), string("bench payout") )
+        );
+      }
+
+      void propose(uint32_t proposer, uint32_t id){
+        call({custodian(proposer)}, [&](daclifycore& c){
+          c.propose(custodian(proposer), "proposal "+to_string(id), "benchmark proposal", vector<action>{transfer_action(member(id % NUM_MEMBERS), 10000)}, now() + 7*24*3600);
+        });
+      }
+
+      void approve(uint32_t approver, uint64_t id){
+        call({custodian(approver)}, [&](daclifycore& c){ c.approve(custodian(approver), id); });
+      }
+
+      void deposit(name from, const string& memo, int64_t amount){
+        call({from}, [&](daclifycore& c){ c.on_transfer(from, GROUP, asset(amount, SYS), memo); }, TOKEN);
+      }
+
+      /**
+       * Returns the open proposal header, or a row with id UINT64_MAX if the proposal is closed.
+       */
+      proposal_row proposal(uint64_t id){
+        sim.begin_action(GROUP.value, {});
+        eosio::multi_index<"proposals"_n, proposal_row> _proposals(GROUP, GROUP.value);
+        auto itr = _proposals.find(id);
+        if(itr == _proposals.end() ){
+          proposal_row closed;
+          closed.id = UINT64_MAX;
+          return closed;
+        }
+        return *itr;
+      }
+
+      /**
+       * Returns true if a proposal is in the archive ring of an archive type.
+       */
+      bool archived(name archive_type, uint64_t id){
+        sim.begin_action(GROUP.value, {});
+        eosio::multi_index<"proparchive"_n, archive_row> _proparchive(GROUP, archive_type.value);
+        for(const archive_row& row : _proparchive){
+          if(row.proposal_id == id && row.outcome == archive_type){
+            return true;
+          }
+        }
+        return false;
+      }
+
+      /**
+       * Returns the SYS balance of an account in one balances layout.
+       */
+      template<name::raw TableName>
+      int64_t balance_in(name account){
+        sim.begin_action(GROUP.value, {});
+        eosio::multi_index<TableName, balance_row> _balances(GROUP, account.value);
+        int64_t total = 0;
+        for(const balance_row& row : _balances){
+          if(row.balance.get_extended_symbol() == extended_symbol(SYS, TOKEN) ){
+            total += row.balance.quantity.amount;
+          }
+        }
+        return total;
+      }
+
+      /**
+       * Returns the SYS balance of an account summed over the tokenbals and the legacy balances layout.
+       */
+      int64_t balance(name account){
+        return balance_in<"tokenbals"_n>(account) + balance_in<"balances"_n>(account);
+      }
+
+      void link_module(name module_name, name module_account){
+        sim.accounts.insert(module_account.value);
+        call({GROUP}, [&](daclifycore& c){ c.linkmodule(module_name, permission_level(module_account, name("active") ), true); });
+      }
+
+      /**
+       * Registers a hook for a core action in the actionhooks table of the hooks module and in the core registry.
+       */
+      void add_hook(name hooked_action){
+        sim.begin_action(HOOKS.value, {});
+        actionhooks_table _actionhooks(HOOKS, HOOKS.value);
+        _actionhooks.emplace(HOOKS, [&](auto& n){
+          n.hook_id = _actionhooks.available_primary_key();
+          n.hooked_action = hooked_action;
+          n.hooked_contract = GROUP;
+          n.hook_action_name = name("exechook");
+          n.enabled = true;
+        });
+        hooked_actions.push_back(hooked_action);
+        call({HOOKS}, [&](daclifycore& c){ c.isethooks(hooked_actions); });
+      }
+
+      /**
+       * Puts the group back on the legacy balances layout, as a group deployed before tokenbals.
+       * Deposits made afterwards go to the legacy balances table.
+       */
+      void use_legacy_balances(){
+        sim.begin_action(GROUP.value, {});
+        eosio::singleton<"corestate"_n, corestate_row> _corestate(GROUP, GROUP.value);
+        corestate_row row = _corestate.get();
+        daclifycore::groupstateext ext = row.ext.value();
+        ext.balances_migrated = false;
+        ext.balance_migration_cursor = 0;
+        row.ext.emplace(ext);
+        _corestate.set(row, GROUP);
+        for(uint32_t i = 0; i < NUM_MEMBERS; i++){
+          deposit(TOKEN, "add to user account: "+member(i).to_string(), 1000000);
+        }
+      }
+
+      /**
+       * Puts the custodians and open proposals back on the layout of the first release, as a group that
+       * still has to run upgrade. Proposal i is approved by its proposer, the next i % 4 custodians and an
+       * account that left the council.
+       */
+      void use_legacy_layout(uint32_t num_proposals){
+        sim.begin_action(GROUP.value, {});
+        eosio::singleton<"corestate"_n, corestate_row> _corestate(GROUP, GROUP.value);
+        corestate_row row = _corestate.get();
+        daclifycore::groupstateext ext = row.ext.value();
+        ext.custodians_upgraded = false;
+        ext.upgrade_cursor = 0;
+        ext.upgraded = false;
+        row.ext.emplace(ext);
+        _corestate.set(row, GROUP);
+
+        eosio::multi_index<"custodians"_n, custodian_row> _custodians(GROUP, GROUP.value);
+        vector<custodian_row> custs;
+        for(const custodian_row& cust : _custodians){
+          custs.push_back(cust);
+        }
+        for(name table : {name("custodians"), name("proposals"), name("propbodies")}){
+          sim.clear_table(GROUP.value, GROUP.value, table.value);
+        }
+
+        eosio::multi_index<"custodians"_n, legacy_custodian_row,
+          eosio::indexed_by<"bylastactive"_n, eosio::const_mem_fun<legacy_custodian_row, uint64_t, &legacy_custodian_row::by_last_active>>
+        > _legacycusts(GROUP, GROUP.value);
+        for(const custodian_row& cust : custs){
+          _legacycusts.emplace(GROUP, [&](auto& n){
+            n.account = cust.account;
+            n.authority = cust.authority;
+            n.weight = cust.weight;
+            n.joined = cust.joined;
+            n.last_active = cust.last_active;
+          });
+        }
+
+        eosio::multi_index<"proposals"_n, legacy_proposal_row,
+          eosio::indexed_by<"bythreshold"_n, eosio::const_mem_fun<legacy_proposal_row, uint64_t, &legacy_proposal_row::by_threshold>>,
+          eosio::indexed_by<"byproposer"_n, eosio::const_mem_fun<legacy_proposal_row, uint64_t, &legacy_proposal_row::by_proposer>>,
+          eosio::indexed_by<"byexpiration"_n, eosio::const_mem_fun<legacy_proposal_row, uint64_t, &legacy_proposal_row::by_expiration>>
+        > _legacyprops(GROUP, GROUP.value);
+        for(uint32_t i = 0; i < num_proposals; i++){
+          _legacyprops.emplace(GROUP, [&](auto& n){
+            n.id = i;
+            n.title = "proposal "+to_string(i);
+            n.description = "benchmark proposal";
+            n.proposer = custodian(i % NUM_CUSTODIANS);
+            n.actions = vector<action>{transfer_action(member(i % NUM_MEMBERS), 10000)};
+            n.submitted = now();
+            n.expiration = now() + 7*24*3600;
+            for(uint32_t a = 0; a <= i % 4; a++){
+              n.approvals.push_back(custodian( (i + a) % NUM_CUSTODIANS) );
+            }
+            n.approvals.push_back(make_account("gone", i) );
+            n.required_threshold = name("default");
+            n.last_actor = n.proposer;
+          });
+        }
+      }
+
+      /**
+       * Seeds a group with custodians, members with balances, thresholds, links and open proposals.
+       */
+      void seed(){
+        sim.reset();
+        hooked_actions.clear();
+        sim.now_us = START_TIME_US;
+        for(name acc : {GROUP, TOKEN, HUB, name("piecesnbits1")}){
+          sim.accounts.insert(acc.value);
+        }
+
+        conf = daclifycore::groupconf();
+        conf.max_custodians = 21;
+        conf.member_registration = true;
+        conf.withdrawals = true;
+        conf.internal_transfers = true;
+        conf.deposits = true;
+        conf.userterms = true;
+        call({GROUP}, [&](daclifycore& c){ c.updateconf(conf, false); });
+
+        for(uint32_t i = 0; i < NUM_CUSTODIANS; i++){
+          sim.accounts.insert(custodian(i).value);
+          call({GROUP}, [&](daclifycore& c){ c.invitecust(custodian(i) ); });
+        }
+        for(uint32_t i = 0; i < NUM_CUSTODIANS; i++){
+          call({custodian(i)}, [&](daclifycore& c){ c.imalive(custodian(i) ); });
+        }
+
+        for(uint32_t i = 0; i < NUM_MEMBERS; i++){
+          sim.accounts.insert(member(i).value);
+          call({member(i)}, [&](daclifycore& c){ c.regmember(member(i) ); });
+          deposit(TOKEN, "add to user account: "+member(i).to_string(), 1000000);
+        }
+        deposit(TOKEN, "group funding", 1000000000);
+
+        for(uint32_t i = 0; i < NUM_THRESHOLDS; i++){
+          name tname = make_account("thr", i);
+          name contract = make_account("ctr", i);
+          sim.accounts.insert(contract.value);
+          call({GROUP}, [&](daclifycore& c){ c.manthreshold(tname, int8_t(2 + i % 5), false); });
+          call({GROUP}, [&](daclifycore& c){ c.manthreshlin(contract, name("transfer"), tname, false); });
+          call({GROUP}, [&](daclifycore& c){ c.manthreshlin(contract, name(0), tname, false); });
+        }
+
+        call({GROUP}, [&](daclifycore& c){ c.filepublish(name("userterms"), "terms v1", checksum256(std::array<uint8_t,32>{1}), 1); });
+
+        for(uint32_t i = 0; i < NUM_PROPOSALS; i++){
+          propose(i % NUM_CUSTODIANS, i);
+        }
+        advance(60);
+      }
+
+      void report(uint32_t iterations){
+        printf("daclifycore native benchmark: %u custodians, %u members, %u open proposals, %u iterations\n",
+          NUM_CUSTODIANS, NUM_MEMBERS, NUM_PROPOSALS, iterations);
+        printf("%-22s %8s %10s %10s %10s %12s %8s %10s\n", "action", "calls", "us/call", "reads", "writes", "bytes", "inline", "inl.bytes");
+        for(const result& r : results){
+          double n = r.calls == 0 ? 1 : r.calls;
+          printf("%-22s %8u %10.2f %10.1f %10.1f %12.1f %8.2f %10.1f\n",
+            r.label.c_str(), r.calls, r.total_us / n,
+            r.totals.db_reads / n, r.totals.db_writes / n, r.totals.bytes_serialized / n,
+            r.totals.inline_actions / n, r.totals.inline_bytes / n);
+        }
+      }
+  };
+
+  void no_setup(world& w){}
+
+  /**
+   * Ids of the open proposals of one proposer, picked so an approver gets a different proposer every round.
+   */
+  vector<uint64_t> batch_ids(uint32_t approver, uint32_t i){
+    uint32_t proposer = (approver + 1 + i / NUM_CUSTODIANS) % NUM_CUSTODIANS;
+    vector<uint64_t> ids;
+    for(uint32_t id = proposer; id < NUM_PROPOSALS; id += NUM_CUSTODIANS){
+      ids.push_back(id);
+    }
+    return ids;
+  }
+
+}
+
+int main(int argc, char** argv){
+  uint32_t iterations = argc > 1 ? uint32_t(atoi(argv[1]) ) : 50;
+  iterations = std::max<uint32_t>(1, std::min<uint32_t>(iterations, NUM_PROPOSALS) );
+
+  chain_sim::get().install();
+  world w;
+
+  //proposals
+  w.bench("propose", iterations, no_setup, [](world& w, uint32_t i, result* r){
+    w.call({custodian(i % NUM_CUSTODIANS)}, [&](daclifycore& c){
+      c.propose(custodian(i % NUM_CUSTODIANS), "bench", "bench proposal", vector<action>{w.transfer_action(member(i), 10000)}, w.now() + 7*24*3600);
+    }, GROUP, r);
+  });
+  w.bench("approve", iterations, no_setup, [](world& w, uint32_t i, result* r){
+    uint32_t approver = (i + 1) % NUM_CUSTODIANS;
+    w.call({custodian(approver)}, [&](daclifycore& c){ c.approve(custodian(approver), i); }, GROUP, r);
+  });
+  w.bench("unapprove", iterations, [](world& w){
+    for(uint32_t i = 0; i < NUM_PROPOSALS; i++){
+      w.approve((i + 1) % NUM_CUSTODIANS, i);
+    }
+  }, [](world& w, uint32_t i, result* r){
+    uint32_t unapprover = (i + 1) % NUM_CUSTODIANS;
+    w.call({custodian(unapprover)}, [&](daclifycore& c){ c.unapprove(custodian(unapprover), i); }, GROUP, r);
+  });
+  w.bench("approvemany", iterations, no_setup, [](world& w, uint32_t i, result* r){
+    //every round an approver picks the proposals of another proposer
+    uint32_t approver = i % NUM_CUSTODIANS;
+    w.call({custodian(approver)}, [&](daclifycore& c){ c.approvemany(custodian(approver), batch_ids(approver, i) ); }, GROUP, r);
+  });
+  w.bench("unapprovmany", iterations, no_setup, [](world& w, uint32_t i, result* r){
+    uint32_t approver = i % NUM_CUSTODIANS;
+    w.call({custodian(approver)}, [&](daclifycore& c){ c.approvemany(custodian(approver), batch_ids(approver, i) ); });
+    w.call({custodian(approver)}, [&](daclifycore& c){ c.unapprovmany(custodian(approver), batch_ids(approver, i) ); }, GROUP, r);
+  });
+  w.bench("exec", iterations, [](world& w){
+    //the proposer and the next custodians approve up to the default threshold
+    for(uint32_t i = 0; i < NUM_PROPOSALS; i++){
+      for(uint32_t a = 1; a < DEFAULT_THRESHOLD; a++){
+        w.approve((i + a) % NUM_CUSTODIANS, i);
+      }
+    }
+  }, [](world& w, uint32_t i, result* r){
+    w.call({custodian(0)}, [&](daclifycore& c){ c.exec(custodian(0), i); }, GROUP, r);
+  });
+  for(uint32_t i = 0; i < iterations; i++){
+    expect(w.proposal(i).id == UINT64_MAX, "exec: proposal "+to_string(i)+" is still open");
+  }
+  expect(w.archived(name("executed"), iterations - 1), "exec: last proposal is not archived as executed");
+  w.bench("approve+exec", iterations, [](world& w){
+    //one approval short of the default threshold, the measured approval executes the proposal
+    for(uint32_t i = 0; i < NUM_PROPOSALS; i++){
+      for(uint32_t a = 1; a < DEFAULT_THRESHOLD - 1; a++){
+        w.approve((i + a) % NUM_CUSTODIANS, i);
+      }
+    }
+    expect(w.proposal(0).approved_weight == DEFAULT_THRESHOLD - 1, "approve+exec: fixture is not one approval short of the threshold");
+    w.conf.exec_on_threshold_reached = true;
+    w.call({GROUP}, [&](daclifycore& c){ c.updateconf(w.conf, false); });
+  }, [](world& w, uint32_t i, result* r){
+    uint32_t approver = (i + DEFAULT_THRESHOLD - 1) % NUM_CUSTODIANS;
+    w.call({custodian(approver)}, [&](daclifycore& c){ c.approve(custodian(approver), i); }, GROUP, r);
+  });
+  for(uint32_t i = 0; i < iterations; i++){
+    expect(w.proposal(i).id == UINT64_MAX, "approve+exec: proposal "+to_string(i)+" is still open");
+  }
+  expect(w.archived(name("executed"), iterations - 1), "approve+exec: last proposal is not archived as executed");
+  w.bench("execsigned", iterations, no_setup, [](world& w, uint32_t i, result* r){
+    //the whole council signs one transaction, no proposal row is written
+    vector<name> approvers;
+    for(uint32_t a = 0; a < NUM_CUSTODIANS; a++){
+      approvers.push_back(custodian(a) );
+    }
+    w.call(approvers, [&](daclifycore& c){ c.execsigned(approvers, vector<action>{w.transfer_action(member(i), 10000)}); }, GROUP, r);
+  });
+  w.bench("cancel", iterations, no_setup, [](world& w, uint32_t i, result* r){
+    uint32_t proposer = i % NUM_CUSTODIANS;
+    w.call({custodian(proposer)}, [&](daclifycore& c){ c.cancel(custodian(proposer), i); }, GROUP, r);
+  });
+  w.bench("trunchistory", iterations, [](world& w){
+    //archive ring large enough to keep every cancelled proposal
+    w.conf.proposal_archive_size = NUM_PROPOSALS;
+    w.call({GROUP}, [&](daclifycore& c){ c.updateconf(w.conf, false); });
+    for(uint32_t i = 0; i < NUM_PROPOSALS; i++){
+      uint32_t proposer = i % NUM_CUSTODIANS;
+      w.call({custodian(proposer)}, [&](daclifycore& c){ c.cancel(custodian(proposer), i); });
+    }
+    //disabling the archive leaves every slot outside the ring
+    w.conf.proposal_archive_size = 0;
+    w.call({GROUP}, [&](daclifycore& c){ c.updateconf(w.conf, false); });
+  }, [](world& w, uint32_t i, result* r){
+    w.call({GROUP}, [&](daclifycore& c){ c.trunchistory(name("cancelled"), 1); }, GROUP, r);
+  });
+  w.bench("purgeexpired", iterations, [](world& w){
+    w.advance(8*24*3600);
+  }, [](world& w, uint32_t i, result* r){
+    w.call({custodian(0)}, [&](daclifycore& c){ c.purgeexpired(1); }, GROUP, r);
+  });
+  w.bench("offchain", iterations, no_setup, [](world& w, uint32_t i, result* r){
+    w.call({GROUP}, [&](daclifycore& c){ c.offchain("offchain task"); }, GROUP, r);
+  });
+
+  //hook dispatch, offchain does nothing but dispatching its hook
+  w.bench("unhooked dispatch", iterations, [](world& w){
+    w.link_module(name("hooks"), HOOKS);
+    w.add_hook(name("approve") );
+  }, [](world& w, uint32_t i, result* r){
+    w.call({GROUP}, [&](daclifycore& c){ c.offchain("offchain task"); }, GROUP, r);
+  });
+  w.bench("hooked dispatch", iterations, [](world& w){
+    w.link_module(name("hooks"), HOOKS);
+    w.add_hook(name("offchain") );
+  }, [](world& w, uint32_t i, result* r){
+    w.call({GROUP}, [&](daclifycore& c){ c.offchain("offchain task"); }, GROUP, r);
+  });
+
+  //custodians
+  w.bench("imalive", iterations, no_setup, [](world& w, uint32_t i, result* r){
+    w.advance(3600);
+    w.call({custodian(i % NUM_CUSTODIANS)}, [&](daclifycore& c){ c.imalive(custodian(i % NUM_CUSTODIANS) ); }, GROUP, r);
+  });
+  w.bench("sweepinactive", iterations, no_setup, [](world& w, uint32_t i, result* r){
+    //the whole council is inactive and comes back in two groups 15 days apart
+    w.advance(31*24*3600);
+    for(uint32_t c = 0; c < NUM_CUSTODIANS; c++){
+      if(c == NUM_CUSTODIANS / 3){
+        w.advance(15*24*3600);
+      }
+      w.call({custodian(c)}, [&](daclifycore& d){ d.imalive(custodian(c) ); });
+    }
+    //the first group goes inactive while it is still in the published authority
+    w.advance(16*24*3600);
+    w.call({custodian(0)}, [&](daclifycore& c){ c.sweepinactive(); }, GROUP, r);
+  });
+  w.bench("upgrade", iterations, [iterations](world& w){
+    w.use_legacy_layout(iterations * UPGRADE_BATCH);
+  }, [](world& w, uint32_t i, result* r){
+    w.call({GROUP}, [&](daclifycore& c){ c.upgrade(UPGRADE_BATCH); }, GROUP, r);
+  });
+  {
+    w.sim.begin_action(GROUP.value, {});
+    eosio::singleton<"corestate"_n, corestate_row> _corestate(GROUP, GROUP.value);
+    expect(_corestate.get().ext.value().upgraded, "upgrade: group is not upgraded after the last batch");
+    eosio::multi_index<"custodians"_n, custodian_row> _custodians(GROUP, GROUP.value);
+    std::map<uint64_t, uint8_t> slots;
+    uint64_t used_slots = 0;
+    for(const custodian_row& cust : _custodians){
+      expect(cust.slot < 64 && !(used_slots & (uint64_t(1) << cust.slot) ), "upgrade: custodian slots are not unique");
+      used_slots |= uint64_t(1) << cust.slot;
+      slots[cust.account.value] = cust.slot;
+    }
+    expect(slots.size() == NUM_CUSTODIANS, "upgrade: custodians are missing");
+    for(uint32_t i = 0; i < iterations * UPGRADE_BATCH; i++){
+      uint64_t approvals = 0;
+      for(uint32_t a = 0; a <= i % 4; a++){
+        approvals |= uint64_t(1) << slots[custodian( (i + a) % NUM_CUSTODIANS).value];
+      }
+      proposal_row prop = w.proposal(i);
+      expect(prop.id == i, "upgrade: proposal "+to_string(i)+" is missing");
+      expect(prop.approvals == approvals && prop.approved_weight == i % 4 + 1, "upgrade: wrong tally of proposal "+to_string(i) );
+    }
+  }
+  w.bench("invitecust", iterations, no_setup, [](world& w, uint32_t i, result* r){
+    name cand = make_account("cand", i);
+    w.sim.accounts.insert(cand.value);
+    w.call({GROUP}, [&](daclifycore& c){ c.invitecust(cand); }, GROUP, r);
+    w.call({GROUP}, [&](daclifycore& c){ c.removecust(cand); });
+  });
+  w.bench("removecust", iterations, no_setup, [](world& w, uint32_t i, result* r){
+    name cand = make_account("cand", i);
+    w.sim.accounts.insert(cand.value);
+    w.call({GROUP}, [&](daclifycore& c){ c.invitecust(cand); });
+    w.call({GROUP}, [&](daclifycore& c){ c.removecust(cand); }, GROUP, r);
+  });
+  w.bench("isetcusts", iterations, [](world& w){
+    w.link_module(name("elections"), ELECTIONS);
+  }, [](world& w, uint32_t i, result* r){
+    //one seat changes per election round
+    vector<name> elected;
+    for(uint32_t c = 0; c < NUM_CUSTODIANS - 1; c++){
+      elected.push_back(custodian(c) );
+    }
+    name newcomer = make_account("cand", i);
+    w.sim.accounts.insert(newcomer.value);
+    elected.push_back(newcomer);
+    w.call({ELECTIONS}, [&](daclifycore& c){ c.isetcusts(elected); }, GROUP, r);
+  });
+  {
+    //the last newcomer holds the reused slot of the replaced custodian, whose approval must not carry over
+    name newcomer = make_account("cand", iterations - 1);
+    uint64_t id = NUM_CUSTODIANS - 1;
+    w.call({newcomer}, [&](daclifycore& c){ c.approve(newcomer, id); });
+    proposal_row prop = w.proposal(id);
+    expect(prop.approved_weight == 1 && __builtin_popcountll(prop.approvals) == 1, "isetcusts: stale approval of a reused slot is still counted");
+  }
+
+  //thresholds
+  w.bench("manthreshold", iterations, no_setup, [](world& w, uint32_t i, result* r){
+    w.call({GROUP}, [&](daclifycore& c){ c.manthreshold(make_account("new", i), 3, false); }, GROUP, r);
+  });
+  w.bench("manthreshlin", iterations, no_setup, [](world& w, uint32_t i, result* r){
+    w.call({GROUP}, [&](daclifycore& c){ c.manthreshlin(make_account("ctr", i % NUM_THRESHOLDS), make_account("act", i), make_account("thr", 0), false); }, GROUP, r);
+  });
+
+  //treasury
+  w.bench("widthdraw", iterations, no_setup, [](world& w, uint32_t i, result* r){
+    w.call({member(i)}, [&](daclifycore& c){ c.widthdraw(member(i), extended_asset(asset(100, SYS), TOKEN) ); }, GROUP, r);
+  });
+  w.bench("widthdraw:stream", iterations, [](world& w){
+    //a month of accrued pay is settled by the withdrawal
+    for(uint32_t i = 0; i < NUM_PROPOSALS; i++){
+      w.call({GROUP}, [&](daclifycore& c){ c.setpaystream(member(i), extended_asset(asset(10000, SYS), TOKEN), 24*3600, time_point_sec(0) ); });
+    }
+    w.advance(30*24*3600);
+  }, [](world& w, uint32_t i, result* r){
+    w.call({member(i)}, [&](daclifycore& c){ c.widthdraw(member(i), extended_asset(asset(100, SYS), TOKEN) ); }, GROUP, r);
+  });
+  w.bench("internalxfr", iterations, no_setup, [](world& w, uint32_t i, result* r){
+    w.call({member(i)}, [&](daclifycore& c){ c.internalxfr(member(i), member(i + 1), extended_asset(asset(100, SYS), TOKEN), "bench"); }, GROUP, r);
+  });
+  w.bench("internalxfrs", iterations, no_setup, [](world& w, uint32_t i, result* r){
+    //one sender pays 20 members
+    vector<daclifycore::transfer> transfers;
+    for(uint32_t t = 1; t <= 20; t++){
+      transfers.push_back(daclifycore::transfer{member(i + t), extended_asset(asset(5, SYS), TOKEN), "bench"});
+    }
+    w.call({member(i)}, [&](daclifycore& c){ c.internalxfrs(member(i), transfers); }, GROUP, r);
+  });
+  {
+    int64_t total = 0;
+    for(uint32_t m = 0; m < NUM_MEMBERS; m++){
+      total += w.balance(member(m) );
+    }
+    expect(total == int64_t(NUM_MEMBERS) * 1000000, "internalxfrs: member balances don't add up to the deposits");
+    expect(w.balance(member(0) ) == 1000000 - 20 * 5, "internalxfrs: sender isn't debited the sum of the transfers");
+  }
+  w.bench("on_transfer:deposit", iterations, no_setup, [](world& w, uint32_t i, result* r){
+    w.call({TOKEN}, [&](daclifycore& c){ c.on_transfer(TOKEN, GROUP, asset(100, SYS), "add to user account: "+member(i).to_string() ); }, TOKEN, r);
+  });
+  w.bench("on_transfer:dep:many", iterations, no_setup, [](world& w, uint32_t i, result* r){
+    //one transfer funds 20 members
+    string memo = "add to user accounts: ";
+    for(uint32_t m = 0; m < 20; m++){
+      memo += (m == 0 ? "" : ",")+member(i + m).to_string()+"=0.0005";
+    }
+    w.call({TOKEN}, [&](daclifycore& c){ c.on_transfer(TOKEN, GROUP, asset(100, SYS), memo); }, TOKEN, r);
+  });
+  for(uint32_t m = 0; m < iterations + 19; m++){
+    int64_t credited = 5 * int64_t(std::min(m, iterations - 1) - (m < 19 ? 0 : m - 19) + 1);
+    expect(w.balance(member(m) ) == 1000000 + credited, "on_transfer:dep:many: "+member(m).to_string()+" got the wrong share");
+  }
+  expect(w.balance(GROUP) == 1000000000, "on_transfer:dep:many: the split left a remainder on the group balance");
+  w.bench("on_transfer:dep:legacy", iterations, [](world& w){
+    w.use_legacy_balances();
+  }, [](world& w, uint32_t i, result* r){
+    w.call({TOKEN}, [&](daclifycore& c){ c.on_transfer(TOKEN, GROUP, asset(100, SYS), "add to user account: "+member(i).to_string() ); }, TOKEN, r);
+  });
+  w.bench("migratebals", iterations, [](world& w){
+    w.use_legacy_balances();
+  }, [](world& w, uint32_t i, result* r){
+    w.call({GROUP}, [&](daclifycore& c){ c.migratebals(10); }, GROUP, r);
+  });
+  {
+    //the group scope is migrated first, then 10 member scopes per call
+    uint32_t migrated = 0;
+    for(uint32_t m = 0; m < NUM_MEMBERS; m++){
+      expect(w.balance(member(m) ) == 2000000, "migratebals: balance of "+member(m).to_string()+" changed");
+      migrated += w.balance_in<"balances"_n>(member(m) ) == 0 ? 1 : 0;
+    }
+    expect(migrated == std::min(NUM_MEMBERS, iterations * 10 - 1), "migratebals: wrong number of migrated scopes");
+  }
+  w.bench("on_transfer:group", iterations, no_setup, [](world& w, uint32_t i, result* r){
+    w.call({TOKEN}, [&](daclifycore& c){ c.on_transfer(TOKEN, GROUP, asset(100, SYS), "donation"); }, TOKEN, r);
+  });
+  w.bench("on_transfer:withdraw", iterations, no_setup, [](world& w, uint32_t i, result* r){
+    w.call({GROUP}, [&](daclifycore& c){ c.on_transfer(GROUP, member(i), asset(100, SYS), "withdraw from user account"); }, TOKEN, r);
+  });
+  w.bench("on_transfer:spend", iterations, no_setup, [](world& w, uint32_t i, result* r){
+    w.call({GROUP}, [&](daclifycore& c){ c.on_transfer(GROUP, TOKEN, asset(100, SYS), "group payment"); }, TOKEN, r);
+  });
+  w.bench("ipayroll", iterations, [](world& w){
+    w.link_module(name("payroll"), PAYROLL);
+  }, [](world& w, uint32_t i, result* r){
+    vector<daclifycore::payment> payments;
+    for(uint32_t p = 0; p < 10; p++){
+      payments.push_back(daclifycore::payment{member(i * 10 + p), asset(1000, SYS)});
+    }
+    w.call({PAYROLL}, [&](daclifycore& c){ c.ipayroll(name("payroll"), name("monthly"), payments, "salary", w.now() + 3600, 12, 30*24*3600, true); }, GROUP, r);
+  });
+  w.bench("clearbals", iterations, no_setup, [](world& w, uint32_t i, result* r){
+    w.call({GROUP}, [&](daclifycore& c){ c.clearbals(member(i) ); }, GROUP, r);
+  });
+
+  //members
+  w.bench("regmember", iterations, no_setup, [](world& w, uint32_t i, result* r){
+    name acc = make_account("newm", i);
+    w.sim.accounts.insert(acc.value);
+    w.call({acc}, [&](daclifycore& c){ c.regmember(acc); }, GROUP, r);
+  });
+  w.bench("unregmember", iterations, [](world& w){
+    for(uint32_t i = 0; i < NUM_PROPOSALS; i++){
+      name acc = make_account("newm", i);
+      w.sim.accounts.insert(acc.value);
+      w.call({acc}, [&](daclifycore& c){ c.regmember(acc); });
+    }
+  }, [](world& w, uint32_t i, result* r){
+    name acc = make_account("newm", i);
+    w.call({acc}, [&](daclifycore& c){ c.unregmember(acc); }, GROUP, r);
+  });
+  w.bench("regmembers", iterations, no_setup, [](world& w, uint32_t i, result* r){
+    //batches of 20 new accounts
+    vector<name> accounts;
+    for(uint32_t a = 0; a < 20; a++){
+      accounts.push_back(make_account("newm", i * 20 + a) );
+      w.sim.accounts.insert(accounts.back().value);
+    }
+    w.call({GROUP}, [&](daclifycore& c){ c.regmembers(accounts); }, GROUP, r);
+  });
+  w.bench("unregmembers", iterations, [](world& w){
+    vector<name> accounts;
+    for(uint32_t a = 0; a < NUM_PROPOSALS * 20; a++){
+      accounts.push_back(make_account("newm", a) );
+      w.sim.accounts.insert(accounts.back().value);
+    }
+    w.call({GROUP}, [&](daclifycore& c){ c.regmembers(accounts); });
+  }, [](world& w, uint32_t i, result* r){
+    vector<name> accounts;
+    for(uint32_t a = 0; a < 20; a++){
+      accounts.push_back(make_account("newm", i * 20 + a) );
+    }
+    w.call({GROUP}, [&](daclifycore& c){ c.unregmembers(accounts); }, GROUP, r);
+  });
+  w.bench("signuserterm", iterations, no_setup, [](world& w, uint32_t i, result* r){
+    w.call({member(i)}, [&](daclifycore& c){ c.signuserterm(member(i), true); }, GROUP, r);
+  });
+  w.bench("updateavatar", iterations, no_setup, [](world& w, uint32_t i, result* r){
+    w.call({member(i)}, [&](daclifycore& c){ c.updateavatar(member(i), "https://example.com/avatar.png"); }, GROUP, r);
+  });
+  w.bench("updatprofile", iterations, no_setup, [](world& w, uint32_t i, result* r){
+    w.call({member(i)}, [&](daclifycore& c){ c.updatprofile(member(i), name("bio"), "benchmark profile"); }, GROUP, r);
+  });
+  w.bench("delprofile", iterations, [](world& w){
+    for(uint32_t i = 0; i < NUM_PROPOSALS; i++){
+      w.call({member(i)}, [&](daclifycore& c){ c.updatprofile(member(i), name("bio"), "benchmark profile"); });
+      w.call({member(i)}, [&](daclifycore& c){ c.updateavatar(member(i), "https://example.com/avatar.png"); });
+    }
+  }, [](world& w, uint32_t i, result* r){
+    w.call({member(i)}, [&](daclifycore& c){ c.delprofile(member(i) ); }, GROUP, r);
+  });
+
+  //group management
+  w.bench("updateconf", iterations, no_setup, [](world& w, uint32_t i, result* r){
+    daclifycore::groupconf conf;
+    conf.max_custodians = 21;
+    conf.member_registration = true;
+    conf.proposal_archive_size = uint8_t(i % 5);
+    w.call({GROUP}, [&](daclifycore& c){ c.updateconf(conf, false); }, GROUP, r);
+  });
+  w.bench("linkmodule", iterations, no_setup, [](world& w, uint32_t i, result* r){
+    name acc = make_account("modl", i);
+    w.sim.accounts.insert(acc.value);
+    w.call({GROUP}, [&](daclifycore& c){ c.linkmodule(make_account("mod", i), permission_level(acc, name("active") ), true); }, GROUP, r);
+  });
+  w.bench("unlinkmodule", iterations, [](world& w){
+    for(uint32_t i = 0; i < NUM_PROPOSALS; i++){
+      w.link_module(make_account("mod", i), make_account("modl", i) );
+    }
+  }, [](world& w, uint32_t i, result* r){
+    w.call({GROUP}, [&](daclifycore& c){ c.unlinkmodule(make_account("mod", i) ); }, GROUP, r);
+  });
+  w.bench("setuiframe", iterations, no_setup, [](world& w, uint32_t i, result* r){
+    w.call({GROUP}, [&](daclifycore& c){ c.setuiframe(i, vector<uint64_t>{1, 2, 3}, "{\"layout\":\"grid\"}"); }, GROUP, r);
+  });
+  w.bench("fileupload", iterations, no_setup, [](world& w, uint32_t i, result* r){
+    w.call({member(i)}, [&](daclifycore& c){ c.fileupload(member(i), name("docs"), string(1024, 'x') ); }, GROUP, r);
+  });
+  w.bench("filepublish", iterations, no_setup, [](world& w, uint32_t i, result* r){
+    w.call({GROUP}, [&](daclifycore& c){ c.filepublish(name("docs"), "document", checksum256(std::array<uint8_t,32>{2}), i + 1); }, GROUP, r);
+  });
+  w.bench("filedelete", iterations, [](world& w){
+    for(uint32_t i = 0; i < NUM_PROPOSALS; i++){
+      w.call({GROUP}, [&](daclifycore& c){ c.filepublish(name("docs"), "document", checksum256(std::array<uint8_t,32>{2}), i + 1); });
+    }
+  }, [](world& w, uint32_t i, result* r){
+    w.call({GROUP}, [&](daclifycore& c){ c.filedelete(name("docs"), i + 1); }, GROUP, r);
+  });
+
+  w.report(iterations);
+  return 0;
+}
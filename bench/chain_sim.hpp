@@ -0,0 +1,663 @@
+#pragma once
+#include <eosio/tester.hpp>
+
+#include <map>
+#include <set>
+#include <vector>
+#include <string>
+#include <cstring>
+
+/**
+ * chain_sim is an in-memory stand-in for the chain intrinsics used by daclifycore.
+ * It is installed into the eosio-cpp native runtime (eosio-cpp -fnative) and implements
+ * the db_*_i64, db_idx64_* and db_idx128_* calls behind multi_index/singleton, plus
+ * the auth, time, transaction and inline action intrinsics.
+ *
+ * Every call is counted so the benchmark can report db reads/writes, serialized bytes
+ * and inline actions per contract action.
+ */
+class chain_sim {
+  public:
+
+    struct counters{
+      uint64_t db_reads = 0;
+      uint64_t db_writes = 0;
+      uint64_t bytes_serialized = 0;
+      uint64_t inline_actions = 0;
+      uint64_t inline_bytes = 0;
+
+      counters& operator+=(const counters& c){
+        db_reads += c.db_reads;
+        db_writes += c.db_writes;
+        bytes_serialized += c.bytes_serialized;
+        inline_actions += c.inline_actions;
+        inline_bytes += c.inline_bytes;
+        return *this;
+      }
+    };
+
+    struct sent_action{
+      uint64_t account;
+      uint64_t action_name;
+      uint32_t size;
+    };
+
+    counters stats;
+    std::vector<sent_action> inline_log;
+
+    //authorities published via eosio::updateauth, only the account entries are modelled
+    struct sim_authority{
+      uint32_t threshold = 0;
+      std::map<std::pair<uint64_t, uint64_t>, uint16_t> accounts;
+    };
+    std::map<std::pair<uint64_t, uint64_t>, sim_authority> permissions;
+
+    uint64_t receiver = 0;
+    uint64_t now_us = 0;
+    std::set<uint64_t> auths;
+    std::set<uint64_t> accounts;
+    std::vector<char> trx;
+
+    static chain_sim& get(){
+      static chain_sim sim;
+      return sim;
+    }
+
+    /**
+     * Wipes all tables, accounts and counters.
+     */
+    void reset(){
+      primary_tables.clear();
+      idx64_tables.clear();
+      idx128_tables.clear();
+      end_tables.clear();
+      primary_itrs.clear();
+      idx64.itrs.clear();
+      idx128.itrs.clear();
+      inline_log.clear();
+      permissions.clear();
+      auths.clear();
+      accounts.clear();
+      stats = counters();
+      trx.assign(256, 'x');
+    }
+
+    /**
+     * Prepares the simulator for a new action: sets receiver and signers and drops the iterator cache.
+     *
+     * @param action_receiver The contract that executes the action.
+     * @param signers The accounts that authorized the action.
+     */
+    void begin_action(uint64_t action_receiver, const std::vector<uint64_t>& signers){
+      receiver = action_receiver;
+      auths = std::set<uint64_t>(signers.begin(), signers.end());
+      primary_itrs.clear();
+      idx64.itrs.clear();
+      idx128.itrs.clear();
+      inline_log.clear();
+      stats = counters();
+    }
+
+    /**
+     * Empties a table and its secondary indexes, lets a benchmark rewrite seeded rows in another layout.
+     *
+     * @param code The contract that owns the table.
+     * @param scope The scope of the table.
+     * @param table The table name.
+     */
+    void clear_table(uint64_t code, uint64_t scope, uint64_t table){
+      primary_table* tab = find_table(code, scope, table);
+      if(tab != nullptr){
+        tab->rows.clear();
+      }
+      //secondary indexes are stored under the table name with the index number in the low 4 bits
+      for(auto& entry : idx64_tables){
+        if(entry.first.code == code && entry.first.scope == scope && (entry.first.table & ~uint64_t(0xF)) == (table & ~uint64_t(0xF)) ){
+          entry.second.entries.clear();
+          entry.second.by_primary.clear();
+        }
+      }
+      for(auto& entry : idx128_tables){
+        if(entry.first.code == code && entry.first.scope == scope && (entry.first.table & ~uint64_t(0xF)) == (table & ~uint64_t(0xF)) ){
+          entry.second.entries.clear();
+          entry.second.by_primary.clear();
+        }
+      }
+    }
+
+    /**
+     * Installs all intrinsics into the native runtime.
+     */
+    void install();
+
+  private:
+
+    struct table_key{
+      uint64_t code;
+      uint64_t scope;
+      uint64_t table;
+      bool operator<(const table_key& o) const {
+        if(code != o.code) return code < o.code;
+        if(scope != o.scope) return scope < o.scope;
+        return table < o.table;
+      }
+    };
+
+    struct primary_table{
+      int32_t end_itr;
+      std::map<uint64_t, std::vector<char>> rows;
+    };
+
+    template<typename K>
+    struct secondary_table{
+      int32_t end_itr;
+      std::set<std::pair<K, uint64_t>> entries;
+      std::map<uint64_t, K> by_primary;
+    };
+
+    struct primary_itr{
+      primary_table* tab;
+      uint64_t primary;
+    };
+
+    template<typename K>
+    struct secondary_itr{
+      secondary_table<K>* tab;
+      uint64_t primary;
+    };
+
+    template<typename K>
+    struct secondary_index{
+      std::map<table_key, secondary_table<K>>* tables;
+      std::vector<secondary_itr<K>> itrs;
+    };
+
+    std::map<table_key, primary_table> primary_tables;
+    std::map<table_key, secondary_table<uint64_t>> idx64_tables;
+    std::map<table_key, secondary_table<uint128_t>> idx128_tables;
+    //end iterators are -2, -3, ... and index into this vector
+    std::vector<void*> end_tables;
+    std::vector<primary_itr> primary_itrs;
+    secondary_index<uint64_t> idx64{&idx64_tables};
+    secondary_index<uint128_t> idx128{&idx128_tables};
+
+    static uint32_t read_varuint(const char*& p){
+      uint32_t value = 0;
+      for(int shift = 0; ; shift += 7){
+        uint8_t b = uint8_t(*p++);
+        value |= uint32_t(b & 0x7f) << shift;
+        if(!(b & 0x80)){
+          return value;
+        }
+      }
+    }
+
+    /**
+     * Records the authority of an eosio::updateauth inline action. Authorities with keys are not modelled.
+     */
+    void record_updateauth(const char* serialized_action){
+      const char* p = serialized_action + 2 * sizeof(uint64_t);
+      p += read_varuint(p) * 2 * sizeof(uint64_t);//authorization
+      read_varuint(p);//data size
+      uint64_t account, permission;
+      memcpy(&account, p, sizeof(uint64_t));
+      memcpy(&permission, p + sizeof(uint64_t), sizeof(uint64_t));
+      p += 3 * sizeof(uint64_t);//account, permission, parent
+      sim_authority auth;
+      memcpy(&auth.threshold, p, sizeof(uint32_t));
+      p += sizeof(uint32_t);
+      if(read_varuint(p) != 0){
+        permissions.erase({account, permission});
+        return;
+      }
+      for(uint32_t n = read_varuint(p); n > 0; n--){
+        uint64_t actor, perm;
+        uint16_t weight;
+        memcpy(&actor, p, sizeof(uint64_t));
+        memcpy(&perm, p + sizeof(uint64_t), sizeof(uint64_t));
+        memcpy(&weight, p + 2 * sizeof(uint64_t), sizeof(uint16_t));
+        p += 2 * sizeof(uint64_t) + sizeof(uint16_t);
+        auth.accounts[{actor, perm}] = weight;
+      }
+      permissions[{account, permission}] = auth;
+    }
+
+    /**
+     * Evaluates provided permission levels against a recorded authority, unknown permissions are satisfied.
+     */
+    bool satisfies(uint64_t account, uint64_t permission, const char* perms_data){
+      auto itr = permissions.find({account, permission});
+      if(itr == permissions.end()){
+        return true;
+      }
+      uint32_t weight = 0;
+      const char* p = perms_data;
+      for(uint32_t n = read_varuint(p); n > 0; n--){
+        uint64_t actor, perm;
+        memcpy(&actor, p, sizeof(uint64_t));
+        memcpy(&perm, p + sizeof(uint64_t), sizeof(uint64_t));
+        p += 2 * sizeof(uint64_t);
+        auto acc = itr->second.accounts.find({actor, perm});
+        weight += acc == itr->second.accounts.end() ? 0 : acc->second;
+      }
+      return weight >= itr->second.threshold;
+    }
+
+    int32_t new_end_itr(void* tab){
+      end_tables.push_back(tab);
+      return -int32_t(end_tables.size()) - 1;
+    }
+
+    void* end_table(int32_t itr){
+      return end_tables.at(-itr - 2);
+    }
+
+    primary_table* find_table(uint64_t code, uint64_t scope, uint64_t table){
+      auto itr = primary_tables.find(table_key{code, scope, table});
+      return itr == primary_tables.end() ? nullptr : &itr->second;
+    }
+
+    primary_table& find_or_create_table(uint64_t code, uint64_t scope, uint64_t table){
+      primary_table* tab = find_table(code, scope, table);
+      if(tab != nullptr){
+        return *tab;
+      }
+      primary_table& created = primary_tables[table_key{code, scope, table}];
+      created.end_itr = new_end_itr(&created);
+      return created;
+    }
+
+    int32_t make_primary_itr(primary_table* tab, uint64_t primary){
+      primary_itrs.push_back(primary_itr{tab, primary});
+      return int32_t(primary_itrs.size()) - 1;
+    }
+
+    template<typename K>
+    secondary_table<K>* find_secondary(secondary_index<K>& idx, uint64_t code, uint64_t scope, uint64_t table){
+      auto itr = idx.tables->find(table_key{code, scope, table});
+      return itr == idx.tables->end() ? nullptr : &itr->second;
+    }
+
+    template<typename K>
+    secondary_table<K>& find_or_create_secondary(secondary_index<K>& idx, uint64_t code, uint64_t scope, uint64_t table){
+      secondary_table<K>* tab = find_secondary(idx, code, scope, table);
+      if(tab != nullptr){
+        return *tab;
+      }
+      secondary_table<K>& created = (*idx.tables)[table_key{code, scope, table}];
+      created.end_itr = new_end_itr(&created);
+      return created;
+    }
+
+    template<typename K>
+    int32_t make_secondary_itr(secondary_index<K>& idx, secondary_table<K>* tab, uint64_t primary){
+      idx.itrs.push_back(secondary_itr<K>{tab, primary});
+      return int32_t(idx.itrs.size()) - 1;
+    }
+
+    //primary index
+
+    int32_t db_store(uint64_t scope, uint64_t table, uint64_t id, const void* data, uint32_t len){
+      primary_table& tab = find_or_create_table(receiver, scope, table);
+      eosio::check(tab.rows.count(id) == 0, "chain_sim: db_store_i64 duplicate primary key");
+      tab.rows[id] = std::vector<char>((const char*)data, (const char*)data + len);
+      stats.db_writes++;
+      stats.bytes_serialized += len;
+      return make_primary_itr(&tab, id);
+    }
+
+    void db_update(int32_t itr, const void* data, uint32_t len){
+      primary_itr& it = primary_itrs.at(itr);
+      it.tab->rows[it.primary] = std::vector<char>((const char*)data, (const char*)data + len);
+      stats.db_writes++;
+      stats.bytes_serialized += len;
+    }
+
+    void db_remove(int32_t itr){
+      primary_itr& it = primary_itrs.at(itr);
+      it.tab->rows.erase(it.primary);
+      stats.db_writes++;
+    }
+
+    int32_t db_get(int32_t itr, void* data, uint32_t len){
+      primary_itr& it = primary_itrs.at(itr);
+      const std::vector<char>& value = it.tab->rows.at(it.primary);
+      if(len == 0){
+        return value.size();
+      }
+      uint32_t copy_size = std::min<uint32_t>(len, value.size());
+      memcpy(data, value.data(), copy_size);
+      stats.db_reads++;
+      stats.bytes_serialized += copy_size;
+      return copy_size;
+    }
+
+    int32_t db_next(int32_t itr, uint64_t* primary){
+      stats.db_reads++;
+      if(itr < -1){
+        return -1;
+      }
+      primary_itr it = primary_itrs.at(itr);
+      auto next = it.tab->rows.upper_bound(it.primary);
+      if(next == it.tab->rows.end()){
+        return it.tab->end_itr;
+      }
+      *primary = next->first;
+      return make_primary_itr(it.tab, next->first);
+    }
+
+    int32_t db_previous(int32_t itr, uint64_t* primary){
+      stats.db_reads++;
+      if(itr < -1){
+        primary_table* tab = (primary_table*)end_table(itr);
+        if(tab->rows.empty()){
+          return -1;
+        }
+        *primary = tab->rows.rbegin()->first;
+        return make_primary_itr(tab, *primary);
+      }
+      primary_itr it = primary_itrs.at(itr);
+      auto prev = it.tab->rows.lower_bound(it.primary);
+      if(prev == it.tab->rows.begin()){
+        return -1;
+      }
+      --prev;
+      *primary = prev->first;
+      return make_primary_itr(it.tab, prev->first);
+    }
+
+    int32_t db_find(uint64_t code, uint64_t scope, uint64_t table, uint64_t id){
+      stats.db_reads++;
+      primary_table* tab = find_table(code, scope, table);
+      if(tab == nullptr){
+        return -1;
+      }
+      if(tab->rows.count(id) == 0){
+        return tab->end_itr;
+      }
+      return make_primary_itr(tab, id);
+    }
+
+    int32_t db_bound(uint64_t code, uint64_t scope, uint64_t table, uint64_t id, bool upper){
+      stats.db_reads++;
+      primary_table* tab = find_table(code, scope, table);
+      if(tab == nullptr){
+        return -1;
+      }
+      auto itr = upper ? tab->rows.upper_bound(id) : tab->rows.lower_bound(id);
+      if(itr == tab->rows.end()){
+        return tab->end_itr;
+      }
+      return make_primary_itr(tab, itr->first);
+    }
+
+    int32_t db_end(uint64_t code, uint64_t scope, uint64_t table){
+      stats.db_reads++;
+      primary_table* tab = find_table(code, scope, table);
+      return tab == nullptr ? -1 : tab->end_itr;
+    }
+
+    //secondary indexes
+
+    template<typename K>
+    int32_t idx_store(secondary_index<K>& idx, uint64_t scope, uint64_t table, uint64_t id, const K& secondary){
+      secondary_table<K>& tab = find_or_create_secondary(idx, receiver, scope, table);
+      tab.entries.insert(std::make_pair(secondary, id));
+      tab.by_primary[id] = secondary;
+      stats.db_writes++;
+      stats.bytes_serialized += sizeof(K);
+      return make_secondary_itr(idx, &tab, id);
+    }
+
+    template<typename K>
+    void idx_update(secondary_index<K>& idx, int32_t itr, const K& secondary){
+      secondary_itr<K>& it = idx.itrs.at(itr);
+      K& current = it.tab->by_primary.at(it.primary);
+      it.tab->entries.erase(std::make_pair(current, it.primary));
+      current = secondary;
+      it.tab->entries.insert(std::make_pair(secondary, it.primary));
+      stats.db_writes++;
+      stats.bytes_serialized += sizeof(K);
+    }
+
+    template<typename K>
+    void idx_remove(secondary_index<K>& idx, int32_t itr){
+      secondary_itr<K>& it = idx.itrs.at(itr);
+      auto current = it.tab->by_primary.find(it.primary);
+      it.tab->entries.erase(std::make_pair(current->second, it.primary));
+      it.tab->by_primary.erase(current);
+      stats.db_writes++;
+    }
+
+    template<typename K>
+    int32_t idx_next(secondary_index<K>& idx, int32_t itr, uint64_t* primary){
+      stats.db_reads++;
+      if(itr < -1){
+        return -1;
+      }
+      secondary_itr<K> it = idx.itrs.at(itr);
+      auto next = it.tab->entries.upper_bound(std::make_pair(it.tab->by_primary.at(it.primary), it.primary));
+      if(next == it.tab->entries.end()){
+        return it.tab->end_itr;
+      }
+      *primary = next->second;
+      return make_secondary_itr(idx, it.tab, next->second);
+    }
+
+    template<typename K>
+    int32_t idx_previous(secondary_index<K>& idx, int32_t itr, uint64_t* primary){
+      stats.db_reads++;
+      if(itr < -1){
+        secondary_table<K>* tab = (secondary_table<K>*)end_table(itr);
+        if(tab->entries.empty()){
+          return -1;
+        }
+        *primary = tab->entries.rbegin()->second;
+        return make_secondary_itr(idx, tab, *primary);
+      }
+      secondary_itr<K> it = idx.itrs.at(itr);
+      auto prev = it.tab->entries.lower_bound(std::make_pair(it.tab->by_primary.at(it.primary), it.primary));
+      if(prev == it.tab->entries.begin()){
+        return -1;
+      }
+      --prev;
+      *primary = prev->second;
+      return make_secondary_itr(idx, it.tab, prev->second);
+    }
+
+    template<typename K>
+    int32_t idx_find_primary(secondary_index<K>& idx, uint64_t code, uint64_t scope, uint64_t table, K* secondary, uint64_t primary){
+      stats.db_reads++;
+      secondary_table<K>* tab = find_secondary(idx, code, scope, table);
+      if(tab == nullptr){
+        return -1;
+      }
+      auto itr = tab->by_primary.find(primary);
+      if(itr == tab->by_primary.end()){
+        return tab->end_itr;
+      }
+      *secondary = itr->second;
+      return make_secondary_itr(idx, tab, primary);
+    }
+
+    template<typename K>
+    int32_t idx_bound(secondary_index<K>& idx, uint64_t code, uint64_t scope, uint64_t table, K* secondary, uint64_t* primary, bool upper, bool exact){
+      stats.db_reads++;
+      secondary_table<K>* tab = find_secondary(idx, code, scope, table);
+      if(tab == nullptr){
+        return -1;
+      }
+      auto itr = tab->entries.lower_bound(std::make_pair(*secondary, uint64_t(0)));
+      if(upper){
+        while(itr != tab->entries.end() && itr->first == *secondary){
+          ++itr;
+        }
+      }
+      if(itr == tab->entries.end() || (exact && itr->first != *secondary) ){
+        return tab->end_itr;
+      }
+      *secondary = itr->first;
+      *primary = itr->second;
+      return make_secondary_itr(idx, tab, itr->second);
+    }
+
+    template<typename K>
+    int32_t idx_end(secondary_index<K>& idx, uint64_t code, uint64_t scope, uint64_t table){
+      stats.db_reads++;
+      secondary_table<K>* tab = find_secondary(idx, code, scope, table);
+      return tab == nullptr ? -1 : tab->end_itr;
+    }
+
+    template<typename K, auto Store, auto Update, auto Remove, auto Next, auto Previous, auto FindPrimary, auto FindSecondary, auto Lowerbound, auto Upperbound, auto End>
+    void install_secondary(secondary_index<K>& idx);
+};
+
+template<typename K, auto Store, auto Update, auto Remove, auto Next, auto Previous, auto FindPrimary, auto FindSecondary, auto Lowerbound, auto Upperbound, auto End>
+void chain_sim::install_secondary(secondary_index<K>& idx){
+  using namespace eosio::native;
+  secondary_index<K>* i = &idx;
+
+  intrinsics::set_intrinsic<Store>([this, i](uint64_t scope, uint64_t table, uint64_t payer, uint64_t id, const K* secondary){
+    return idx_store(*i, scope, table, id, *secondary);
+  });
+  intrinsics::set_intrinsic<Update>([this, i](int32_t itr, uint64_t payer, const K* secondary){
+    idx_update(*i, itr, *secondary);
+  });
+  intrinsics::set_intrinsic<Remove>([this, i](int32_t itr){
+    idx_remove(*i, itr);
+  });
+  intrinsics::set_intrinsic<Next>([this, i](int32_t itr, uint64_t* primary){
+    return idx_next(*i, itr, primary);
+  });
+  intrinsics::set_intrinsic<Previous>([this, i](int32_t itr, uint64_t* primary){
+    return idx_previous(*i, itr, primary);
+  });
+  intrinsics::set_intrinsic<FindPrimary>([this, i](uint64_t code, uint64_t scope, uint64_t table, K* secondary, uint64_t primary){
+    return idx_find_primary(*i, code, scope, table, secondary, primary);
+  });
+  intrinsics::set_intrinsic<FindSecondary>([this, i](uint64_t code, uint64_t scope, uint64_t table, const K* secondary, uint64_t* primary){
+    K key = *secondary;
+    return idx_bound(*i, code, scope, table, &key, primary, false, true);
+  });
+  intrinsics::set_intrinsic<Lowerbound>([this, i](uint64_t code, uint64_t scope, uint64_t table, K* secondary, uint64_t* primary){
+    return idx_bound(*i, code, scope, table, secondary, primary, false, false);
+  });
+  intrinsics::set_intrinsic<Upperbound>([this, i](uint64_t code, uint64_t scope, uint64_t table, K* secondary, uint64_t* primary){
+    return idx_bound(*i, code, scope, table, secondary, primary, true, false);
+  });
+  intrinsics::set_intrinsic<End>([this, i](uint64_t code, uint64_t scope, uint64_t table){
+    return idx_end(*i, code, scope, table);
+  });
+}
+
+inline void chain_sim::install(){
+  using namespace eosio::native;
+
+  //primary index
+  intrinsics::set_intrinsic<intrinsics::db_store_i64>([this](uint64_t scope, uint64_t table, uint64_t payer, uint64_t id, const void* data, uint32_t len){
+    return db_store(scope, table, id, data, len);
+  });
+  intrinsics::set_intrinsic<intrinsics::db_update_i64>([this](int32_t itr, uint64_t payer, const void* data, uint32_t len){
+    db_update(itr, data, len);
+  });
+  intrinsics::set_intrinsic<intrinsics::db_remove_i64>([this](int32_t itr){
+    db_remove(itr);
+  });
+  intrinsics::set_intrinsic<intrinsics::db_get_i64>([this](int32_t itr, void* data, uint32_t len){
+    return db_get(itr, data, len);
+  });
+  intrinsics::set_intrinsic<intrinsics::db_next_i64>([this](int32_t itr, uint64_t* primary){
+    return db_next(itr, primary);
+  });
+  intrinsics::set_intrinsic<intrinsics::db_previous_i64>([this](int32_t itr, uint64_t* primary){
+    return db_previous(itr, primary);
+  });
+  intrinsics::set_intrinsic<intrinsics::db_find_i64>([this](uint64_t code, uint64_t scope, uint64_t table, uint64_t id){
+    return db_find(code, scope, table, id);
+  });
+  intrinsics::set_intrinsic<intrinsics::db_lowerbound_i64>([this](uint64_t code, uint64_t scope, uint64_t table, uint64_t id){
+    return db_bound(code, scope, table, id, false);
+  });
+  intrinsics::set_intrinsic<intrinsics::db_upperbound_i64>([this](uint64_t code, uint64_t scope, uint64_t table, uint64_t id){
+    return db_bound(code, scope, table, id, true);
+  });
+  intrinsics::set_intrinsic<intrinsics::db_end_i64>([this](uint64_t code, uint64_t scope, uint64_t table){
+    return db_end(code, scope, table);
+  });
+
+  //secondary indexes
+  install_secondary<uint64_t,
+    intrinsics::db_idx64_store, intrinsics::db_idx64_update, intrinsics::db_idx64_remove,
+    intrinsics::db_idx64_next, intrinsics::db_idx64_previous, intrinsics::db_idx64_find_primary,
+    intrinsics::db_idx64_find_secondary, intrinsics::db_idx64_lowerbound, intrinsics::db_idx64_upperbound,
+    intrinsics::db_idx64_end>(idx64);
+  install_secondary<uint128_t,
+    intrinsics::db_idx128_store, intrinsics::db_idx128_update, intrinsics::db_idx128_remove,
+    intrinsics::db_idx128_next, intrinsics::db_idx128_previous, intrinsics::db_idx128_find_primary,
+    intrinsics::db_idx128_find_secondary, intrinsics::db_idx128_lowerbound, intrinsics::db_idx128_upperbound,
+    intrinsics::db_idx128_end>(idx128);
+
+  //authorization and accounts
+  intrinsics::set_intrinsic<intrinsics::require_auth>([this](uint64_t account){
+    eosio::check(auths.count(account) > 0, "chain_sim: missing authority of " + eosio::name(account).to_string() );
+  });
+  intrinsics::set_intrinsic<intrinsics::require_auth2>([this](uint64_t account, uint64_t permission){
+    eosio::check(auths.count(account) > 0, "chain_sim: missing authority of " + eosio::name(account).to_string() );
+  });
+  intrinsics::set_intrinsic<intrinsics::has_auth>([this](uint64_t account){
+    return auths.count(account) > 0;
+  });
+  intrinsics::set_intrinsic<intrinsics::is_account>([this](uint64_t account){
+    return accounts.count(account) > 0;
+  });
+  intrinsics::set_intrinsic<intrinsics::require_recipient>([](uint64_t account){});
+  intrinsics::set_intrinsic<intrinsics::check_permission_authorization>(
+    [this](uint64_t account, uint64_t permission, const char* pubkeys_data, uint32_t pubkeys_size, const char* perms_data, uint32_t perms_size, uint64_t delay_us){
+      return int32_t(satisfies(account, permission, perms_data) ? 1 : 0);
+  });
+  intrinsics::set_intrinsic<intrinsics::current_receiver>([this](){
+    return receiver;
+  });
+
+  //time and transaction
+  intrinsics::set_intrinsic<intrinsics::current_time>([this](){
+    return now_us;
+  });
+  intrinsics::set_intrinsic<intrinsics::transaction_size>([this](){
+    return trx.size();
+  });
+  intrinsics::set_intrinsic<intrinsics::read_transaction>([this](char* buffer, size_t size){
+    size_t copy_size = std::min(size, trx.size());
+    memcpy(buffer, trx.data(), copy_size);
+    return int(copy_size);
+  });
+  //not a real sha256, only needs to be deterministic for the benchmark
+  intrinsics::set_intrinsic<intrinsics::sha256>([](const char* data, uint32_t length, capi_checksum256* hash){
+    uint64_t h = 1469598103934665603ULL;
+    for(uint32_t i = 0; i < length; i++){
+      h = (h ^ uint8_t(data[i])) * 1099511628211ULL;
+    }
+    for(uint32_t i = 0; i < 32; i++){
+      hash->hash[i] = uint8_t(h >> ((i % 8) * 8));
+    }
+  });
+
+  //inline actions are recorded, not executed
+  intrinsics::set_intrinsic<intrinsics::send_inline>([this](char* serialized_action, size_t size){
+    sent_action sent{};
+    memcpy(&sent.account, serialized_action, sizeof(uint64_t));
+    memcpy(&sent.action_name, serialized_action + sizeof(uint64_t), sizeof(uint64_t));
+    sent.size = size;
+    if(sent.account == eosio::name("eosio").value && sent.action_name == eosio::name("updateauth").value){
+      record_updateauth(serialized_action);
+    }
+    inline_log.push_back(sent);
+    stats.inline_actions++;
+    stats.inline_bytes += size;
+    stats.bytes_serialized += size;
+  });
+
+  //silence contract prints
+  intrinsics::set_intrinsic<intrinsics::prints>([](const char* cstr){});
+  intrinsics::set_intrinsic<intrinsics::prints_l>([](const char* cstr, uint32_t len){});
+}
@@ -0,0 +1 @@
+eosio-cpp -fnative src/daclifycore.cpp bench/bench.cpp -Iinclude -Ibench -o bench/daclifycore_bench
@@ -4,6 +4,7 @@
 //#include <eosio/system.hpp>
 #include <eosio/permission.hpp>
 #include <eosio/singleton.hpp>
+#include <resource_stats.hpp>
 #include <system_structs.hpp>
 #include <external_structs.hpp>
 
@@ -15,6 +16,7 @@ using namespace eosio;
 CONTRACT daclifycore : public contract {
   public:
     using contract::contract;
+    ~daclifycore();
 
     struct action_threshold{
       name action_name;
@@ -32,11 +34,33 @@ CONTRACT daclifycore : public contract {
       uint64_t member_count;
     };
 
+    //state added after the first release, stored as binary extension of the corestate row
+    struct groupstateext{
+      uint32_t cust_epoch;//bumped on every change of the custodian set, invalidates proposal tallies
+      uint64_t cust_slots;//bitmap of the custodian slots in use
+      checksum256 active_auth_hash;//sha256 of the last published active authority
+      uint64_t executed_count;//executed proposals archived since the ring last shrank, the newest is in slot (executed_count-1) % proposal_archive_size
+      uint64_t cancelled_count;//cancelled proposals archived since the ring last shrank
+      uint64_t expired_count;//expired proposals archived since the ring last shrank
+      uint32_t policy_version;//version of the compiled threshold policy
+      uint64_t balance_migration_cursor;//next balances scope to migrate, 0 is the group scope otherwise a lower bound on members
+      bool balances_migrated;//all balances are in the primary keyed tokenbals layout
+      bool custodians_upgraded;//custodians rows of the first release are converted, see upgrade
+      uint64_t upgrade_cursor;//next open proposal of the first release to convert
+      bool upgraded;//custodians and open proposals are in the current layout
+    };
+
     struct payment{
         eosio::name receiver;
         eosio::asset amount;
     };
 
+    struct transfer{
+        eosio::name to;
+        eosio::extended_asset amount;
+        string memo;
+    };
+
     //json
     /*
         {
@@ -52,9 +76,9 @@ CONTRACT daclifycore : public contract {
           "deposits": false,
           "maintainer_account": {"actor": "piecesnbits1", "permission":"active"},
           "hub_account": "daclifyhub11",
-          "r1": false,
-          "r2": false,
-          "r3": 0
+          "exec_on_threshold_reached": false,
+          "hub_notify_mode": 0,
+          "purge_expired_on_propose": 0
         }
     */
     //
@@ -73,9 +97,9 @@ CONTRACT daclifycore : public contract {
       permission_level maintainer_account = permission_level(name("daclifyhub11"), name("active") );//!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
       name hub_account = name("daclifyhub11");
       
-      bool r1;
-      bool r2;
-      uint64_t r3;
+      bool exec_on_threshold_reached = false;//the approval that reaches the required threshold executes the proposal (was r1)
+      uint8_t hub_notify_mode = 0;//delivery of hub notifications, see hubmode (was r2)
+      uint64_t purge_expired_on_propose = 0;//max expired proposals archived by every propose, 0 disables (was r3)
       //user_agreement user_agreement;
     };
 
@@ -83,21 +107,31 @@ CONTRACT daclifycore : public contract {
     ACTION removecust(name account);
 
     ACTION isetcusts(vector<name> accounts);//"elections" module interface action
+    ACTION isethooks(vector<name> hooked_actions);//"hooks" module interface action
 
     //(name payroll_tag, vector<payment> payments, time_point_sec due_date, uint8_t repeat, uint64_t recurrence_sec, bool auto_pay)
     ACTION ipayroll(name sender_module_name, name payroll_tag, vector<payment> payments, string memo, time_point_sec due_date, uint8_t repeat, uint64_t recurrence_sec, bool auto_pay);
+    ACTION setpaystream(name account, extended_asset rate, uint32_t period_sec, time_point_sec end);
 
     ACTION propose(name proposer, string title, string description, vector<action> actions, time_point_sec expiration);
     ACTION approve(name approver, uint64_t id);
     ACTION offchain(const string&  description);
     ACTION unapprove(name unapprover, uint64_t id);
+    ACTION approvemany(name approver, vector<uint64_t> ids);
+    ACTION unapprovmany(name unapprover, vector<uint64_t> ids);
     ACTION cancel(name canceler, uint64_t id);
     ACTION exec(name executer, uint64_t id);
+    ACTION execsigned(vector<name> approvers, vector<action> actions);
     ACTION trunchistory(name archive_type, uint32_t batch_size);
+    ACTION purgeexpired(uint32_t max_rows);
 
     ACTION widthdraw(name account, extended_asset amount);
     ACTION internalxfr(name from, name to, extended_asset amount, string msg);
+    ACTION internalxfrs(name from, vector<transfer> transfers);
+    ACTION migratebals(uint32_t max_scopes);
     ACTION imalive(name account);
+    ACTION sweepinactive();
+    ACTION upgrade(uint32_t max_rows);
     //ACTION spawnchildac(name new_account, asset ram_amount, asset net_amount, asset cpu_amount, name parent, name module_name);
     //ACTION addchildac(name account, name parent, name module_name);
    // ACTION remchildac(name account);
@@ -113,6 +147,8 @@ CONTRACT daclifycore : public contract {
 
     ACTION regmember(name actor);
     ACTION unregmember(name actor);
+    ACTION regmembers(vector<name> accounts);
+    ACTION unregmembers(vector<name> accounts);
     ACTION signuserterm(name member, bool agree_terms);
     ACTION updateavatar(name actor, string img_url);
     ACTION updatprofile(name actor, name key, string data);
@@ -139,16 +175,50 @@ CONTRACT daclifycore : public contract {
       uint8_t threshold;
     };
 
+    //hook event as delivered to the hooks module in the exechooks batch
+    struct hookevent{
+      name hooked_action;
+      name hook_action_name;
+      uint64_t context;//id of the object the action worked on (ie proposal id), 0 if not applicable
+    };
+
+    //verbs of the transfer memo grammar
+    enum class memoverb : uint8_t {
+      none,
+      deposit,//add to user account: alice
+      deposit_many,//add to user accounts: alice=10,bob=5.5
+      withdraw//withdraw from user account
+    };
+
+    //delivery of the hub notifications, groupconf.hub_notify_mode
+    enum class hubmode : uint8_t {
+      messagebus,//one messagebus action per event, supported by every hub
+      msgbatch,//one msgbatch action with all events of the contract action
+      recipient//the hub is only added as recipient of the contract action
+    };
+
+    //hub notification as delivered to the hub in the msgbatch outbox
+    struct hubevent{
+      name event;
+      name actor;
+      vector<uint64_t> ids;
+      vector<name> receivers;
+    };
+
 
     TABLE coreconf{
       groupconf conf;
     };
-    typedef eosio::singleton<"coreconf"_n, coreconf> coreconf_table;
+    typedef resourcestats::metered_singleton<"coreconf"_n, coreconf> coreconf_table;
 
     TABLE corestate{
       groupstate state;
+      binary_extension<groupstateext> ext;//missing in rows written by the first release
     };
-    typedef eosio::singleton<"corestate"_n, corestate> corestate_table;
+    typedef resourcestats::metered_singleton<"corestate"_n, corestate> corestate_table;
+
+    //cached state of the action context, the corestate row with its extension applied
+    struct fullstate : groupstate, groupstateext {};
 
     TABLE threshlinks {
       uint64_t id;
@@ -161,7 +231,7 @@ CONTRACT daclifycore : public contract {
       uint64_t by_threshold() const { return threshold_name.value; }
       uint128_t by_cont_act() const { return (uint128_t{contract.value} << 64) | action_name.value; }
     };
-    typedef multi_index<name("threshlinks"), threshlinks,
+    typedef resourcestats::metered_multi_index<name("threshlinks"), threshlinks,
       //eosio::indexed_by<"byaction"_n, eosio::const_mem_fun<threshlinks, uint64_t, &threshlinks::by_action>>,
       eosio::indexed_by<"bythreshold"_n, eosio::const_mem_fun<threshlinks, uint64_t, &threshlinks::by_threshold>>,
       eosio::indexed_by<"bycontact"_n, eosio::const_mem_fun<threshlinks, uint128_t, &threshlinks::by_cont_act>>
@@ -172,46 +242,140 @@ CONTRACT daclifycore : public contract {
       int8_t threshold;
       auto primary_key() const { return threshold_name.value; }
     };
-    typedef multi_index<name("thresholds"), thresholds> thresholds_table;
+    typedef resourcestats::metered_multi_index<name("thresholds"), thresholds> thresholds_table;
 
+    struct policylink{
+      name contract;
+      name action_name;
+      name threshold_name;
+    };
+
+    struct policythreshold{
+      name threshold_name;
+      int8_t threshold;
+    };
+
+    //thresholds and threshlinks compiled into one sorted row, rebuilt on every threshold or link change
+    TABLE threshpolicy{
+      uint32_t version;
+      vector<policylink> links;//sorted by contract, action_name
+      vector<policythreshold> thresholds;//sorted by threshold_name
+    };
+    typedef resourcestats::metered_singleton<"threshpolicy"_n, threshpolicy> threshpolicy_table;
+
+    //proposal header, small fixed size row that is rewritten on every vote
     TABLE proposals {
       uint64_t id;
-      string title;
-      string description;
       name proposer;
-      vector<action> actions;
       time_point_sec submitted;
       time_point_sec expiration;
-      vector<name> approvals;
+      uint64_t approvals;//bitmap of the custodian slots that approved
       name required_threshold;
       name last_actor;
-      checksum256 trx_id;
+      uint8_t approved_weight;//running tally of the approvals, valid while tally_epoch == cust_epoch
+      uint32_t tally_epoch;
+      uint8_t required_threshold_value;//resolved value of required_threshold, valid while policy_version matches
+      uint32_t policy_version;
 
       auto primary_key() const { return id; }
       uint64_t by_threshold() const { return required_threshold.value; }
       uint64_t by_proposer() const { return proposer.value; }
       uint64_t by_expiration() const { return expiration.sec_since_epoch(); }
     };
-    typedef multi_index<name("proposals"), proposals,
+    typedef resourcestats::metered_multi_index<name("proposals"), proposals,
       eosio::indexed_by<"bythreshold"_n, eosio::const_mem_fun<proposals, uint64_t, &proposals::by_threshold>>,
       eosio::indexed_by<"byproposer"_n, eosio::const_mem_fun<proposals, uint64_t, &proposals::by_proposer>>,
       eosio::indexed_by<"byexpiration"_n, eosio::const_mem_fun<proposals, uint64_t, &proposals::by_expiration>>
     > proposals_table;
 
+    //proposal body, immutable, same id and scope as the proposal header
+    TABLE propbodies {
+      uint64_t id;
+      string title;
+      string description;
+      vector<action> actions;
+      checksum256 trx_id;
+
+      auto primary_key() const { return id; }
+    };
+    typedef resourcestats::metered_multi_index<name("propbodies"), propbodies> propbodies_table;
+
+    //archived proposal, scoped by archive type. Content can be recovered from chain history via trx_id
+    TABLE proparchive {
+      uint64_t id;//ring slot
+      uint64_t proposal_id;
+      name proposer;
+      name outcome;
+      vector<name> approvals;//custodians that approved, resolved from the slots when archived
+      name last_actor;
+      time_point_sec submitted;
+      time_point_sec expiration;
+      time_point_sec archived;
+      checksum256 trx_id;
+      checksum256 actions_hash;//sha256 of the packed actions
+
+      auto primary_key() const { return id; }
+    };
+    typedef resourcestats::metered_multi_index<name("proparchive"), proparchive> proparchive_table;
+
     TABLE custodians {
       name account;
       name authority = name("active");
       uint8_t weight = 1;
       time_point_sec joined = time_point_sec(current_time_point().sec_since_epoch());
       time_point_sec last_active;
+      time_point_sec inactive_after;//liveness deadline, precomputed from last_active and inactivate_cust_after_sec
+      uint8_t slot;//stable index of the custodian in the proposal approvals bitmap
+      uint32_t slot_epoch;//custodian epoch in which the slot was assigned
 
       auto primary_key() const { return account.value; }
       uint64_t by_last_active() const { return last_active.sec_since_epoch(); }
+      uint64_t by_slot() const { return slot; }
     };
-    typedef multi_index<name("custodians"), custodians,
-      eosio::indexed_by<"bylastactive"_n, eosio::const_mem_fun<custodians, uint64_t, &custodians::by_last_active>>
+    typedef resourcestats::metered_multi_index<name("custodians"), custodians,
+      eosio::indexed_by<"bylastactive"_n, eosio::const_mem_fun<custodians, uint64_t, &custodians::by_last_active>>,
+      eosio::indexed_by<"byslot"_n, eosio::const_mem_fun<custodians, uint64_t, &custodians::by_slot>>
     > custodians_table;
 
+    //custodians and open proposals layout of the first release, only read by upgrade
+    struct legacycusts {
+      name account;
+      name authority;
+      uint8_t weight;
+      time_point_sec joined;
+      time_point_sec last_active;
+
+      auto primary_key() const { return account.value; }
+      uint64_t by_last_active() const { return last_active.sec_since_epoch(); }
+    };
+    typedef multi_index<name("custodians"), legacycusts,
+      eosio::indexed_by<"bylastactive"_n, eosio::const_mem_fun<legacycusts, uint64_t, &legacycusts::by_last_active>>
+    > legacycusts_table;
+
+    struct legacyprops {
+      uint64_t id;
+      string title;
+      string description;
+      name proposer;
+      vector<action> actions;
+      time_point_sec submitted;
+      time_point_sec expiration;
+      vector<name> approvals;
+      name required_threshold;
+      name last_actor;
+      checksum256 trx_id;
+
+      auto primary_key() const { return id; }
+      uint64_t by_threshold() const { return required_threshold.value; }
+      uint64_t by_proposer() const { return proposer.value; }
+      uint64_t by_expiration() const { return expiration.sec_since_epoch(); }
+    };
+    typedef multi_index<name("proposals"), legacyprops,
+      eosio::indexed_by<"bythreshold"_n, eosio::const_mem_fun<legacyprops, uint64_t, &legacyprops::by_threshold>>,
+      eosio::indexed_by<"byproposer"_n, eosio::const_mem_fun<legacyprops, uint64_t, &legacyprops::by_proposer>>,
+      eosio::indexed_by<"byexpiration"_n, eosio::const_mem_fun<legacyprops, uint64_t, &legacyprops::by_expiration>>
+    > legacyprops_table;
+
     TABLE members {
       name account;
       time_point_sec member_since;
@@ -220,14 +384,27 @@ CONTRACT daclifycore : public contract {
       auto primary_key() const { return account.value; }
 
     };
-    typedef multi_index<name("members"), members> members_table;
+    typedef resourcestats::metered_multi_index<name("members"), members> members_table;
+
+    //streaming pay, accrues from the group balance and is credited lazily to the member balance
+    TABLE paystreams {
+      name account;
+      extended_asset rate;//accrues per period_sec
+      uint32_t period_sec;
+      time_point_sec start;
+      time_point_sec end;//time_point_sec(0) for an open ended stream
+      int64_t claimed;//amount credited since start
+      int64_t carried;//unpaid pay of earlier terms, the row is kept until it is credited
+      auto primary_key() const { return account.value; }
+    };
+    typedef resourcestats::metered_multi_index<name("paystreams"), paystreams> paystreams_table;
 
     TABLE avatars {
       name account;
       string img_url;
       auto primary_key() const { return account.value; }
     };
-    typedef multi_index<name("avatars"), avatars> avatars_table;
+    typedef resourcestats::metered_multi_index<name("avatars"), avatars> avatars_table;
 
     TABLE profiledata {
       name account;
@@ -236,7 +413,7 @@ CONTRACT daclifycore : public contract {
       uint64_t r1;
       auto primary_key() const { return account.value; }
     };
-    typedef multi_index<name("profiledata"), profiledata> profiledata_table;
+    typedef resourcestats::metered_multi_index<name("profiledata"), profiledata> profiledata_table;
 
     //scoped table (example: userterms)
     TABLE dacfiles {
@@ -248,7 +425,7 @@ CONTRACT daclifycore : public contract {
       uint64_t primary_key()const { return id; }
       uint64_t by_published() const { return published.sec_since_epoch(); }
     };
-    typedef multi_index<"dacfiles"_n, dacfiles,
+    typedef resourcestats::metered_multi_index<"dacfiles"_n, dacfiles,
       eosio::indexed_by<"bypublished"_n, eosio::const_mem_fun<dacfiles, uint64_t, &dacfiles::by_published>>
     > dacfiles_table;
 
@@ -260,9 +437,17 @@ CONTRACT daclifycore : public contract {
       uint64_t primary_key()const { return id; }
       uint128_t by_contr_sym() const { return (uint128_t{balance.contract.value} << 64) | balance.quantity.symbol.raw(); }
     };
-    typedef multi_index<"balances"_n, balances,
+    typedef resourcestats::metered_multi_index<"balances"_n, balances,
       eosio::indexed_by<"bycontrsym"_n, eosio::const_mem_fun<balances, uint128_t, &balances::by_contr_sym>>
-    > balances_table;
+    > balances_table;//legacy layout, replaced by tokenbals
+
+    //scoped by account, key is derived from the token contract and symbol
+    TABLE tokenbals {
+      uint64_t key;
+      extended_asset balance;
+      uint64_t primary_key()const { return key; }
+    };
+    typedef resourcestats::metered_multi_index<"tokenbals"_n, tokenbals> tokenbals_table;
 
     //scoped by user
     TABLE uiframes {
@@ -271,7 +456,7 @@ CONTRACT daclifycore : public contract {
       string data;
       uint64_t primary_key() const { return frame_id; }
     };
-    typedef multi_index<name("uiframes"), uiframes> uiframes_table;
+    typedef resourcestats::metered_multi_index<name("uiframes"), uiframes> uiframes_table;
     
     TABLE modules {
 
@@ -283,12 +468,65 @@ CONTRACT daclifycore : public contract {
       auto primary_key() const { return module_name.value; }
       uint64_t by_module_acc() const { return slave_permission.actor.value; }
     };
-    typedef multi_index<name("modules"), modules,
+    typedef resourcestats::metered_multi_index<name("modules"), modules,
       eosio::indexed_by<"bymoduleacc"_n, eosio::const_mem_fun<modules, uint64_t, &modules::by_module_acc>>
     > modules_table;
 
+    //local registry of the actions that have a hook, maintained by the hooks module via isethooks
+    TABLE hookreg{
+      vector<name> hooked_actions;//sorted
+    };
+    typedef resourcestats::metered_singleton<"hookreg"_n, hookreg> hookreg_table;
+
+    //resource accounting per action, only written when compiled with -DRESOURCE_STATS
+    TABLE actionstats {
+      name action_name;
+      uint64_t calls;
+      vector<resourcestats::tableops> tables;
+      uint64_t inline_actions;
+      uint64_t inline_bytes;
+      uint64_t hook_dispatches;
+      int64_t ram_delta;
+      time_point_sec last_call;
+      auto primary_key() const { return action_name.value; }
+    };
+    typedef multi_index<name("actionstats"), actionstats> actionstats_table;
+
+    //action scoped context//
+    //table handles are shared by all helpers so rows are read from chain at most once per action.
+    //config, state and module rows are loaded lazily, a dirty state is written back in the destructor.
+    coreconf_table _coreconf{get_self(), get_self().value};
+    corestate_table _corestate{get_self(), get_self().value};
+    custodians_table _custodians{get_self(), get_self().value};
+    modules_table _modules{get_self(), get_self().value};
+    thresholds_table _thresholds{get_self(), get_self().value};
+    threshlinks_table _threshlinks{get_self(), get_self().value};
+    members_table _members{get_self(), get_self().value};
+    paystreams_table _paystreams{get_self(), get_self().value};
+    proposals_table _proposals{get_self(), get_self().value};
+    propbodies_table _propbodies{get_self(), get_self().value};
+    hookreg_table _hookreg{get_self(), get_self().value};
+    threshpolicy_table _threshpolicy{get_self(), get_self().value};
+
+    std::optional<groupconf> _conf;
+    std::optional<fullstate> _state;
+    bool _state_dirty = false;
+    std::map<uint64_t, const modules*> _module_rows;
+    std::optional<vector<name>> _hooked_actions;
+    vector<hookevent> _hook_events;
+    vector<hubevent> _hub_events;
+    std::optional<threshpolicy> _policy;
+    bool _policy_dirty = false;
+
     //functions//
-    groupconf get_group_conf();
+    const groupconf& get_group_conf();
+    void set_group_conf(const groupconf& new_conf, const bool& remove);
+    const fullstate& get_group_state();
+    fullstate& modify_group_state();
+    void require_upgraded();
+    const modules* get_module(const name& module_name);
+    void forget_module(const name& module_name);
+    void flush_context();
     bool is_account_voice_wrapper(const name& account);
     void update_owner_maintainance(const permission_level& maintainer);
     //action whitelist stuff
@@ -304,31 +542,80 @@ CONTRACT daclifycore : public contract {
     void update_thresholds_based_on_number_custodians();
     threshold_name_and_value get_required_threshold_name_and_value_for_contract_action(const name& contract, const name& action_name);
     bool is_threshold_linked(const name& threshold_name);
+    const threshpolicy& get_threshold_policy();
+    void compile_threshold_policy();
+    const policylink* find_policy_link(const name& contract, const name& action_name);
 
     //vector<threshold_name_and_value> get_counts_for
     //https://eosio.stackexchange.com/questions/4999/how-do-i-pass-an-iterator/5012#5012
     uint8_t get_total_approved_proposal_weight(proposals_table::const_iterator& prop_itr);
+    uint8_t get_approved_weight(proposals_table::const_iterator& prop_itr);
+    uint8_t tally_approvals(uint64_t& approvals, const uint32_t& validated_epoch);
+    vector<name> get_approvers(const uint64_t& approvals, const uint32_t& validated_epoch);
+    void refresh_approval_tally(proposals& prop);
+    void invalidate_approval_tallies();
     
     //custodians
     bool is_custodian(const name& account, const bool& update_last_active, const bool& check_if_alive);
     void update_custodian_weight(const name& account, const uint8_t& weight);
-    void update_active();
+    bool update_active();
+    bool is_active_authority_live(const vector<eosiosystem::permission_level_weight>& accounts);
     void update_custodian_last_active(const name& account);
-    bool is_account_alive(time_point_sec last_active);
+    bool is_account_alive(time_point_sec inactive_after);
+    time_point_sec get_inactive_deadline(time_point_sec last_active);
+    void update_inactive_deadlines();
     void update_custodian_count(int delta);
+    uint8_t assign_custodian_slot();
+    void release_custodian_slot(const uint8_t& slot);
+
+    //transfer memos
+    memoverb parse_memo_verb(std::string_view memo, std::string_view& args);
+    int64_t parse_memo_amount(std::string_view text, const symbol& sym);
+    void deposit_many(std::string_view args, const extended_asset& quantity);
 
     //internal accounting
     void sub_balance(const name& account, const extended_asset& value);
     void add_balance(const name& account, const extended_asset& value);
+    void sub_legacy_balance(const name& account, const extended_asset& value);
+    void add_legacy_balance(const name& account, const extended_asset& value);
+    uint64_t get_balance_key(const extended_symbol& sym);
+    extended_asset get_balance(const name& account, const extended_symbol& sym);
+    bool is_balance_scope_migrated(const name& account);
+    void migrate_balance_scope(const name& account);
 
     //proposals
     void delete_proposal(const uint64_t& id);
-    void approve_proposal(const uint64_t& id, const name& approver);
+    bool approve_proposal(const uint64_t& id, const custodians& approver);
+    void unapprove_proposal(const uint64_t& id, const custodians& unapprover);
     //void assert_invalid_authorization( vector<permission_level> auths);
+    uint8_t get_proposal_threshold(const proposals& prop);
+    void execute_proposal(proposals_table::const_iterator& prop_itr);
+    void send_proposal_actions(const vector<action>& actions);
+    threshold_name_and_value get_max_required_threshold(const vector<action>& actions);
     void archive_proposal(const name& archive_type, proposals_table& idx, proposals_table::const_iterator& prop_itr);
+    void write_archive_row(const name& archive_type, const proposals& prop, const propbodies* body);
+    uint64_t& get_archive_counter(const name& archive_type);
+    uint32_t purge_expired_proposals(const uint32_t& max_rows);
 
     bool has_module(const name& module_name);
 
+    //hooks
+    bool is_hooked(const name& hooked_action);
+    void hookmanager(const name& hooked_action, const uint64_t& context = 0);
+    void flush_hook_events();
+
+    //hub notifications
+    void notify_hub(const name& event, const name& actor, const uint64_t& id, const vector<name>& receivers = {});
+    void flush_hub_events();
+
+    //resource accounting
+    void send_action(const action& act);
+    void flush_action_stats();
+
+    //pay streams
+    int64_t get_stream_owed(const paystreams& stream);
+    int64_t settle_stream(const name& account);
+
     //members
     bool is_member(const name& accountname);
     bool member_has_balance(const name& accountname);
@@ -372,35 +659,4 @@ CONTRACT daclifycore : public contract {
       return trx_id;
     }
 
-    struct  hookmanager{
-
-      hookmanager(eosio::name hooked_action, eosio::name self_)  { 
-
-        modules_table _modules(self_, self_.value);
-        auto mod_itr = _modules.find(eosio::name("hooks").value );
-        if(mod_itr != _modules.end() ){
-        
-          eosio::name hooks_contract = mod_itr->slave_permission.actor;
-          actionhooks_table _actionhooks(hooks_contract, hooks_contract.value);
-          auto by_hook = _actionhooks.get_index<"byhook"_n>();
-          uint128_t composite_id = (uint128_t{hooked_action.value} << 64) | self_.value;
-          auto hook_itr = by_hook.find(composite_id);
-          if(hook_itr != by_hook.end() ){
-            if(hook_itr->enabled){
-              eosio::action(
-                  eosio::permission_level{ self_, "owner"_n },
-                  hooks_contract,
-                  hook_itr->hook_action_name,
-                  std::make_tuple( hooked_action )
-              ).send();
-            }
-          }
-        }
-      }
-
-    };
-
-
-};
-
-
+};
\ No newline at end of file
@@ -12,7 +12,7 @@
       uint128_t by_hook() const { return (uint128_t{hooked_action.value} << 64) | hooked_contract.value; }
 
     };
-    typedef eosio::multi_index<eosio::name("actionhooks"), actionhooks,
+    typedef resourcestats::metered_multi_index<eosio::name("actionhooks"), actionhooks,
       eosio::indexed_by<"byhook"_n, eosio::const_mem_fun<actionhooks, uint128_t, &actionhooks::by_hook>>
     > actionhooks_table;
 
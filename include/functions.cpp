@@ -1,14 +1,119 @@
 /**
- * Returns the configuration (groupconf struct) from the coreconf table
+ * Returns the configuration (groupconf struct) from the coreconf table.
+ * The config is read once per action, a missing config returns the defaults without writing them.
  * 
  * @return The groupconf struct is being returned.
  */
-daclifycore::groupconf daclifycore::get_group_conf(){
-  //groupconf conf;
-  //return conf;
-  coreconf_table _coreconf(get_self(), get_self().value);
-  auto setting = _coreconf.get_or_create(get_self(), coreconf());
-  return setting.conf;
+const daclifycore::groupconf& daclifycore::get_group_conf(){
+  if(!_conf){
+    _conf = _coreconf.get_or_default(coreconf()).conf;
+  }
+  return *_conf;
+}
+
+/**
+ * Writes a new configuration to the coreconf table and keeps the cached config in sync
+ * 
+ * @param new_conf The new configuration.
+ * @param remove If true, the configuration will be removed.
+ */
+void daclifycore::set_group_conf(const groupconf& new_conf, const bool& remove){
+  if(remove){
+    _coreconf.remove();
+    _conf.reset();
+    return;
+  }
+  _coreconf.set(coreconf{new_conf}, get_self());
+  _conf = new_conf;
+}
+
+/**
+ * Returns the state from the corestate table, read once per action. Without the extension (a group of the
+ * first release, or no state yet) the extension is derived from the tables once and written back.
+ * 
+ * @return The groupstate with its extension.
+ */
+const daclifycore::fullstate& daclifycore::get_group_state(){
+  if(!_state){
+    corestate row = _corestate.get_or_default(corestate() );
+    _state = fullstate();
+    static_cast<groupstate&>(*_state) = row.state;
+    if(row.ext.has_value() ){
+      static_cast<groupstateext&>(*_state) = row.ext.value();
+    }
+    else{
+      //only rows in the first release layout need an upgrade or a balances migration
+      legacycusts_table _legacycusts(get_self(), get_self().value);
+      legacyprops_table _legacyprops(get_self(), get_self().value);
+      balances_table _balances(get_self(), get_self().value);
+      _state->custodians_upgraded = _legacycusts.begin() == _legacycusts.end();
+      _state->upgraded = _state->custodians_upgraded && _legacyprops.begin() == _legacyprops.end();
+      _state->balances_migrated = _balances.begin() == _balances.end() && _members.begin() == _members.end();
+      _state_dirty = true;
+    }
+  }
+  return *_state;
+}
+
+/**
+ * Returns the cached state for modification, the state is written back once when the action ends
+ * 
+ * @return A reference to the cached state.
+ */
+daclifycore::fullstate& daclifycore::modify_group_state(){
+  get_group_state();
+  _state_dirty = true;
+  return *_state;
+}
+
+/**
+ * Aborts actions on custodians and proposals while rows of the first release layout are not converted
+ */
+void daclifycore::require_upgraded(){
+  check(get_group_state().upgraded, "Group data must be upgraded first, see the upgrade action.");
+}
+
+/**
+ * Returns the row of a linked module, each module row is read once per action
+ * 
+ * @param module_name The name of the module to look for
+ * 
+ * @return pointer to the module row or nullptr if the module isn't linked
+ */
+const daclifycore::modules* daclifycore::get_module(const name& module_name){
+  auto cached = _module_rows.find(module_name.value);
+  if(cached != _module_rows.end() ){
+    return cached->second;
+  }
+  auto itr = _modules.find(module_name.value);
+  const modules* row = itr == _modules.end() ? nullptr : &(*itr);
+  _module_rows[module_name.value] = row;
+  return row;
+}
+
+/**
+ * Drops a module from the cache, must be called when the modules row is added or erased
+ * 
+ * @param module_name The name of the module
+ */
+void daclifycore::forget_module(const name& module_name){
+  _module_rows.erase(module_name.value);
+}
+
+/**
+ * Writes the dirty singletons of the action context back to the tables
+ */
+void daclifycore::flush_context(){
+  if(_policy_dirty){
+    compile_threshold_policy();
+  }
+  if(_state_dirty){
+    corestate row;
+    row.state = *_state;
+    row.ext.emplace(*_state);
+    _corestate.set(row, get_self());
+    _state_dirty = false;
+  }
 }
 
 /**
@@ -25,7 +130,6 @@ bool daclifycore::is_member(const name& accountname){
   else if(accountname == get_self() ){
     return true; 
   }
-  members_table _members(get_self(), get_self().value);
   auto mem_itr = _members.find(accountname.value);
   
   if(mem_itr == _members.end() ){
@@ -46,12 +150,282 @@ bool daclifycore::is_member(const name& accountname){
  * @return true if the module exists, otherwise false
  */
 bool daclifycore::has_module(const name& module_name){
-  modules_table _modules(get_self(), get_self().value);
-  auto itr = _modules.find(module_name.value);
-  return itr != _modules.end();
+  return get_module(module_name) != nullptr;
+}
+
+/**
+ * Checks the local hook registry, the registry is read once per action
+ * 
+ * @param hooked_action The name of the core action
+ * 
+ * @return true if the hooks module registered a hook for the action
+ */
+bool daclifycore::is_hooked(const name& hooked_action){
+  if(!_hooked_actions){
+    _hooked_actions = _hookreg.get_or_default(hookreg()).hooked_actions;
+  }
+  return std::binary_search(_hooked_actions->begin(), _hooked_actions->end(), hooked_action);
+}
+
+/**
+ * Queues the hook event of an action, the queue is dispatched once when the action ends.
+ * Unhooked actions return after the registry check.
+ * 
+ * @param hooked_action The name of the core action that just ran
+ * @param context The id of the object the action worked on, 0 if not applicable
+ */
+void daclifycore::hookmanager(const name& hooked_action, const uint64_t& context){
+  if(is_hooked(hooked_action) ){
+    _hook_events.push_back(hookevent{hooked_action, name(0), context});
+  }
+}
+
+/**
+ * Resolves the queued hook events against the actionhooks table of the hooks module and sends all
+ * enabled ones as a single exechooks inline action. Each distinct hooked action is looked up once.
+ */
+void daclifycore::flush_hook_events(){
+  if(_hook_events.size() == 0){
+    return;
+  }
+  const modules* hooks_module = get_module(name("hooks") );
+  if(hooks_module == nullptr){
+    _hook_events.clear();
+    return;
+  }
+  name hooks_contract = hooks_module->slave_permission.actor;
+  actionhooks_table _actionhooks(hooks_contract, hooks_contract.value);
+  auto by_hook = _actionhooks.get_index<"byhook"_n>();
+
+  //distinct hooked actions of the queue
+  vector<name> hooked;
+  for(const hookevent& event : _hook_events){
+    hooked.push_back(event.hooked_action);
+  }
+  std::sort(hooked.begin(), hooked.end() );
+  hooked.erase(std::unique(hooked.begin(), hooked.end() ), hooked.end() );
+
+  //one byhook find per distinct hooked action
+  std::map<uint64_t, name> hook_action_names;
+  for(const name& hooked_action : hooked){
+    auto hook_itr = by_hook.find( (uint128_t{hooked_action.value} << 64) | get_self().value);
+    if(hook_itr != by_hook.end() && hook_itr->enabled){
+      hook_action_names[hooked_action.value] = hook_itr->hook_action_name;
+    }
+  }
+
+  vector<hookevent> events;
+  for(hookevent event : _hook_events){
+    auto hook = hook_action_names.find(event.hooked_action.value);
+    if(hook != hook_action_names.end() ){
+      event.hook_action_name = hook->second;
+      events.push_back(event);
+    }
+  }
+  _hook_events.clear();
+
+  if(events.size() != 0){
+    action hook_act = action(
+        permission_level{ get_self(), "owner"_n },
+        hooks_contract,
+        "exechooks"_n,
+        std::make_tuple(get_self(), events)
+    );
+    resourcestats::track_hook(hook_act);
+    hook_act.send();
+  }
+}
+
+/**
+ * Runs when the action is done, dispatches the queued hook events and flushes the action context and
+ * the resource accounting of the action
+ */
+daclifycore::~daclifycore(){
+  flush_hook_events();
+  flush_hub_events();
+  flush_context();
+  flush_action_stats();
+}
+
+/**
+ * Queues a hub notification, the outbox is flushed once when the action ends. Events with the same
+ * name, actor and receivers are merged into one entry.
+ * 
+ * @param event The event name
+ * @param actor The account that caused the event
+ * @param id The id of the object the event is about (ie proposal id)
+ * @param receivers Accounts the hub should notify, empty for the group feed
+ */
+void daclifycore::notify_hub(const name& event, const name& actor, const uint64_t& id, const vector<name>& receivers){
+  for(hubevent& queued : _hub_events){
+    if(queued.event == event && queued.actor == actor && queued.receivers == receivers){
+      queued.ids.push_back(id);
+      return;
+    }
+  }
+  _hub_events.push_back(hubevent{event, actor, vector<uint64_t>{id}, receivers});
+}
+
+/**
+ * Delivers the queued hub notifications. By default every event is sent as a messagebus action, the
+ * action every hub implements. hub_notify_mode can switch to a single msgbatch action or to only adding
+ * the hub as recipient of the current action.
+ */
+void daclifycore::flush_hub_events(){
+  if(_hub_events.size() == 0){
+    return;
+  }
+  const groupconf& conf = get_group_conf();
+  if(conf.hub_account != get_self() && is_account(conf.hub_account) ){
+    hubmode mode = hubmode(conf.hub_notify_mode);
+    if(mode == hubmode::recipient){
+      require_recipient(conf.hub_account);
+    }
+    else if(mode == hubmode::msgbatch){
+      send_action(action(
+          permission_level{ get_self(), "owner"_n },
+          conf.hub_account,
+          "msgbatch"_n,
+          std::make_tuple(get_self(), _hub_events) //name sender_group, vector<hubevent> events
+      ) );
+    }
+    else{
+      for(const hubevent& event : _hub_events){
+        string msg = event.event == name("propose") ? "New proposal by "+event.actor.to_string() : event.event.to_string()+" by "+event.actor.to_string();
+        for(size_t i = 0; i < event.ids.size(); i++){
+          send_action(action(
+              permission_level{ get_self(), "owner"_n },
+              conf.hub_account,
+              "messagebus"_n,
+              std::make_tuple(get_self(), event.event, msg, event.receivers) //name sender_group, name event, string message, vector<name> receivers
+          ) );
+        }
+      }
+    }
+  }
+  _hub_events.clear();
+}
+
+/**
+ * Sends an inline action and books it on the resource accounting of the current action
+ * 
+ * @param act The action to send
+ */
+void daclifycore::send_action(const action& act){
+  resourcestats::track_inline(act);
+  act.send();
+}
+
+/**
+ * Adds the counters collected during this action to the actionstats table.
+ * Only active when compiled with -DRESOURCE_STATS.
+ */
+void daclifycore::flush_action_stats(){
+#ifdef RESOURCE_STATS
+  resourcestats::tracker& t = resourcestats::current();
+  if(t.action_name.value == 0){
+    return;
+  }
+  actionstats_table _actionstats(get_self(), get_self().value);
+  auto itr = _actionstats.find(t.action_name.value);
+  auto merge = [&](auto& n){
+    n.calls += 1;
+    for(const resourcestats::tableops& ops : t.tables){
+      auto existing = std::find_if(n.tables.begin(), n.tables.end(), [&](const resourcestats::tableops& e){ return e.table == ops.table; });
+      if(existing == n.tables.end() ){
+        n.tables.push_back(ops);
+      }
+      else{
+        existing->finds += ops.finds;
+        existing->emplaces += ops.emplaces;
+        existing->modifies += ops.modifies;
+        existing->erases += ops.erases;
+        existing->ram_delta += ops.ram_delta;
+      }
+    }
+    n.inline_actions += t.inline_actions;
+    n.inline_bytes += t.inline_bytes;
+    n.hook_dispatches += t.hook_dispatches;
+    n.ram_delta += t.ram_delta();
+    n.last_call = time_point_sec(current_time_point() );
+  };
+  if(itr == _actionstats.end() ){
+    _actionstats.emplace(get_self(), [&](auto& n){
+      n.action_name = t.action_name;
+      merge(n);
+    });
+  }
+  else{
+    _actionstats.modify(itr, same_payer, merge);
+  }
+  t = resourcestats::tracker();
+#endif
+}
+
+/**
+ * Computes the amount a pay stream accrued since its start plus the carried pay of earlier terms that
+ * is not credited yet
+ * 
+ * @param stream The pay stream row
+ * 
+ * @return The owed amount.
+ */
+int64_t daclifycore::get_stream_owed(const paystreams& stream){
+  uint32_t now = current_time_point().sec_since_epoch();
+  if(stream.end != time_point_sec(0) && stream.end.sec_since_epoch() < now){
+    now = stream.end.sec_since_epoch();
+  }
+  if(now <= stream.start.sec_since_epoch() ){
+    return stream.carried - stream.claimed;
+  }
+  uint128_t accrued = uint128_t(stream.rate.quantity.amount) * (now - stream.start.sec_since_epoch() ) / stream.period_sec;
+  if(accrued > uint128_t(asset::max_amount) ){
+    accrued = asset::max_amount;
+  }
+  return int64_t(accrued) + stream.carried - stream.claimed;
+}
+
+/**
+ * Credits the accrued pay of a member's stream from the group balance to the member balance. The cost
+ * doesn't depend on the number of elapsed periods. When the group balance can't cover it the available
+ * part is credited and the rest stays owed. A stopped stream is removed once nothing is owed.
+ * 
+ * @param account The member
+ * 
+ * @return The amount that stays owed, 0 if the member has no stream.
+ */
+int64_t daclifycore::settle_stream(const name& account){
+  auto itr = _paystreams.find(account.value);
+  if(itr == _paystreams.end() ){
+    return 0;
+  }
+  int64_t owed = get_stream_owed(*itr);
+  if(owed <= 0){
+    return 0;
+  }
+  extended_symbol sym = itr->rate.get_extended_symbol();
+  int64_t pay = std::min(owed, get_balance(get_self(), sym).quantity.amount);
+  if(pay <= 0){
+    return owed;
+  }
+  sub_balance(get_self(), extended_asset(pay, sym) );
+  add_balance(account, extended_asset(pay, sym) );
+  if(pay == owed && itr->rate.quantity.amount == 0){
+    //a stopped stream is removed once its carried pay is credited
+    _paystreams.erase(itr);
+    return 0;
+  }
+  _paystreams.modify( itr, same_payer, [&]( auto& n) {
+      n.claimed += pay;
+  });
+  return owed - pay;
 }
 
 bool daclifycore::member_has_balance(const name& accountname){
+  if(is_balance_scope_migrated(accountname) ){
+    tokenbals_table _tokenbals( get_self(), accountname.value);
+    return _tokenbals.begin() != _tokenbals.end();
+  }
   balances_table _balances( get_self(), accountname.value);
   if(_balances.begin() != _balances.end() ){
     return true;
@@ -68,11 +442,8 @@ bool daclifycore::member_has_balance(const name& accountname){
  * @param delta The amount to change the member count by.
  */
 void daclifycore::update_member_count(int delta){
-
-  corestate_table _corestate(get_self(), get_self().value);
-  auto state = _corestate.get_or_create(get_self(), corestate());
-  state.state.member_count = state.state.member_count + delta;
-  _corestate.set(state, get_self());
+  fullstate& state = modify_group_state();
+  state.member_count = state.member_count + delta;
 }
 
 /**
@@ -81,11 +452,30 @@ void daclifycore::update_member_count(int delta){
  * @param delta The amount to add to the custodian count.
  */
 void daclifycore::update_custodian_count(int delta){
+  fullstate& state = modify_group_state();
+  state.cust_count = state.cust_count + delta;
+}
 
-  corestate_table _corestate(get_self(), get_self().value);
-  auto state = _corestate.get_or_create(get_self(), corestate());
-  state.state.cust_count = state.state.cust_count + delta;
-  _corestate.set(state, get_self());
+/**
+ * Reserves the lowest free custodian slot
+ * 
+ * @return The reserved slot.
+ */
+uint8_t daclifycore::assign_custodian_slot(){
+  fullstate& state = modify_group_state();
+  check(~state.cust_slots != 0, "All custodian slots are in use.");
+  uint8_t slot = __builtin_ctzll(~state.cust_slots);
+  state.cust_slots |= uint64_t(1) << slot;
+  return slot;
+}
+
+/**
+ * Frees a custodian slot, the slot can be reassigned in a later custodian epoch
+ * 
+ * @param slot The slot to free.
+ */
+void daclifycore::release_custodian_slot(const uint8_t& slot){
+  modify_group_state().cust_slots &= ~(uint64_t(1) << slot);
 }
 
 /**
@@ -113,18 +503,18 @@ bool daclifycore::is_account_voice_wrapper(const name& account){
  */
 bool daclifycore::is_custodian(const name& account, const bool& update_last_active, const bool& check_if_alive) {
 
-  custodians_table _custodians(get_self(), get_self().value);
   auto cust_itr = _custodians.find(account.value);
   if(cust_itr == _custodians.end() ){
     return false;
   }
   else{
     if(check_if_alive){
-      check(is_account_alive(cust_itr->last_active), "You've been inactive, please verify you're alive first.");
+      check(is_account_alive(cust_itr->inactive_after), "You've been inactive, please verify you're alive first.");
     }
     if(update_last_active){
       _custodians.modify( cust_itr, same_payer, [&]( auto& a) {
           a.last_active = time_point_sec(current_time_point().sec_since_epoch());
+          a.inactive_after = get_inactive_deadline(a.last_active);
       });
     }
     return true;
@@ -137,31 +527,55 @@ bool daclifycore::is_custodian(const name& account, const bool& update_last_acti
  * @param account the account name of the custodian to update
  */
 void daclifycore::update_custodian_last_active(const name& account){
-  custodians_table _custodians(get_self(), get_self().value);
   auto cust_itr = _custodians.find(account.value);
   check(cust_itr != _custodians.end(), "Internal group error: trying to update non existing custodian.");
   _custodians.modify( cust_itr, same_payer, [&]( auto& a) {
       a.last_active = time_point_sec(current_time_point().sec_since_epoch());
+      a.inactive_after = get_inactive_deadline(a.last_active);
   });
 }
 
 /**
  * is_account_alive checks if a custodian is still active (alive)
  * 
- * @param last_active The last time the account was active.
+ * @param inactive_after The precomputed liveness deadline of the custodian.
  * 
  * @return true if the custodian account is still alive, i.e. has
  * performed activities within the timeout period (inactivate_cust_after_sec) specified in the configuration
  */
-bool daclifycore::is_account_alive(time_point_sec last_active){
-  
-  bool is_alive = (last_active == time_point_sec(0) );
-  if(get_group_conf().inactivate_cust_after_sec != 0){
-    time_point_sec now = time_point_sec(current_time_point());
-    uint32_t inactive_period = now.sec_since_epoch() - last_active.sec_since_epoch();
-    is_alive = (inactive_period >= get_group_conf().inactivate_cust_after_sec);
+bool daclifycore::is_account_alive(time_point_sec inactive_after){
+  return time_point_sec(current_time_point() ) < inactive_after;
+}
+
+/**
+ * Computes the liveness deadline for a custodian that was last active at last_active.
+ * Without an inactivity timeout a custodian stays alive once it has been active.
+ * 
+ * @param last_active The last time the account was active.
+ * 
+ * @return The time from which the custodian is considered inactive.
+ */
+time_point_sec daclifycore::get_inactive_deadline(time_point_sec last_active){
+  uint32_t inactivate_cust_after_sec = get_group_conf().inactivate_cust_after_sec;
+  if(inactivate_cust_after_sec == 0){
+    return last_active == time_point_sec(0) ? time_point_sec(0) : time_point_sec(UINT32_MAX);
+  }
+  uint64_t deadline = uint64_t(last_active.sec_since_epoch() ) + inactivate_cust_after_sec;
+  return time_point_sec(deadline > UINT32_MAX ? UINT32_MAX : uint32_t(deadline) );
+}
+
+/**
+ * Recomputes the liveness deadline of all custodians, must be called when inactivate_cust_after_sec changes
+ */
+void daclifycore::update_inactive_deadlines(){
+  for(auto itr = _custodians.begin(); itr != _custodians.end(); itr++){
+    time_point_sec deadline = get_inactive_deadline(itr->last_active);
+    if(deadline != itr->inactive_after){
+      _custodians.modify( itr, same_payer, [&]( auto& a) {
+          a.inactive_after = deadline;
+      });
+    }
   }
-  return !is_alive;
 }
 
 
@@ -211,20 +625,21 @@ void daclifycore::update_owner_maintainance(const permission_level& maintainer){
         .keys = {}
   };
 
-  action(
+  send_action(action(
     permission_level{get_self(), "owner"_n},
     "eosio"_n, "updateauth"_n,
     std::make_tuple(get_self(), "owner"_n, ""_n, new_owner_authority)
-  ).send();
+  ) );
 
 }
 
 /**
  * Updates the active authority of the contract to the active custodians
+ * 
+ * @return true if a new active authority was published
  */
-void daclifycore::update_active() {
+bool daclifycore::update_active() {
 
-  custodians_table _custodians(get_self(), get_self().value);
 
   vector<eosiosystem::permission_level_weight> accounts;//active custodians
   vector<eosiosystem::permission_level_weight> inactive_accounts;//inactive custodians
@@ -236,7 +651,7 @@ void daclifycore::update_active() {
           .weight = (uint16_t) 1,
     };
 
-    if(is_account_alive(itr->last_active) ){
+    if(is_account_alive(itr->inactive_after) ){
       accounts.push_back(account);
     }
     else{
@@ -253,12 +668,18 @@ void daclifycore::update_active() {
         .keys = {}
   };
 
-  action(
-    permission_level{get_self(), "owner"_n},
-    "eosio"_n, "updateauth"_n,
-    std::make_tuple(get_self(), "active"_n, "owner"_n, new_authority)
-  ).send();
-
+  //only publish the authority when it differs from the last published one and nobody replaced it since
+  auto packed_authority = pack(new_authority);
+  checksum256 auth_hash = sha256(packed_authority.data(), packed_authority.size() );
+  bool published = auth_hash != get_group_state().active_auth_hash || !is_active_authority_live(accounts);
+  if(published){
+    send_action(action(
+      permission_level{get_self(), "owner"_n},
+      "eosio"_n, "updateauth"_n,
+      std::make_tuple(get_self(), "active"_n, "owner"_n, new_authority)
+    ) );
+    modify_group_state().active_auth_hash = auth_hash;
+  }
 
   uint8_t default_threshold;
   if(accounts.size() == 1){
@@ -272,7 +693,133 @@ void daclifycore::update_active() {
     default_threshold = default_threshold <= 0 ? 1 : default_threshold;
   }
 
-  insert_or_update_or_delete_threshold(name("default"), default_threshold, false, true);
+  auto thresh_itr = _thresholds.find(name("default").value);
+  if(thresh_itr == _thresholds.end() || thresh_itr->threshold != default_threshold){
+    insert_or_update_or_delete_threshold(name("default"), default_threshold, false, true);
+  }
+  return published;
+}
+
+/**
+ * Checks the live active permission against an authority published by update_active. That authority
+ * needs every listed account, so the live permission must be satisfied by the full list and by none of
+ * the lists with one account dropped. Detects listed accounts that were removed or re-weighted outside
+ * the contract. Accounts or keys that were added outside the contract can't be detected, contracts
+ * can't read a permission, such an authority is only replaced when the custodian set changes.
+ * 
+ * @param accounts The accounts of the authority, all with weight 1
+ * 
+ * @return true if the live active permission still requires every one of these accounts
+ */
+bool daclifycore::is_active_authority_live(const vector<eosiosystem::permission_level_weight>& accounts){
+  vector<permission_level> perms;
+  for(const eosiosystem::permission_level_weight& plw : accounts){
+    perms.push_back(plw.permission);
+  }
+  auto satisfies = [&](const vector<permission_level>& provided){
+    auto packed_perms = pack(provided);
+    return eosio::check_permission_authorization(
+        get_self(), name("active"),
+        (const char *) 0, 0,
+        packed_perms.data(), packed_perms.size(),
+        microseconds(0)
+    ) > 0;
+  };
+  if(!satisfies(perms) ){
+    return false;
+  }
+  for(size_t i = 0; i < perms.size(); i++){
+    vector<permission_level> without = perms;
+    without.erase(without.begin() + i);
+    if(satisfies(without) ){
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Matches the start of a transfer memo against the memo verbs, the memo is not copied
+ * 
+ * @param memo The transfer memo
+ * @param args Set to the part of the memo after the verb
+ * 
+ * @return The verb, memoverb::none for a free text memo.
+ */
+daclifycore::memoverb daclifycore::parse_memo_verb(std::string_view memo, std::string_view& args){
+  static constexpr std::pair<std::string_view, memoverb> verbs[] = {
+    {"add to user account: ", memoverb::deposit},
+    {"add to user accounts: ", memoverb::deposit_many},
+    {"withdraw from user account", memoverb::withdraw}
+  };
+  for(const auto& verb : verbs){
+    if(memo.substr(0, verb.first.size() ) == verb.first){
+      args = memo.substr(verb.first.size() );
+      return verb.second;
+    }
+  }
+  return memoverb::none;
+}
+
+/**
+ * Parses a decimal memo amount like 10 or 5.25 into the smallest unit of the symbol
+ * 
+ * @param text The amount text
+ * @param sym The symbol that defines the precision
+ * 
+ * @return The amount in the smallest unit.
+ */
+int64_t daclifycore::parse_memo_amount(std::string_view text, const symbol& sym){
+  check(text.size() > 0, "Missing amount in memo.");
+  int64_t amount = 0;
+  int decimals = -1;
+  for(char c : text){
+    if(c == '.'){
+      check(decimals < 0, "Invalid amount in memo.");
+      decimals = 0;
+      continue;
+    }
+    check(c >= '0' && c <= '9', "Invalid amount in memo.");
+    if(decimals >= 0){
+      check(++decimals <= sym.precision(), "Too many decimals in memo amount.");
+    }
+    check(amount <= (asset::max_amount - (c - '0') ) / 10, "Memo amount out of range.");
+    amount = amount * 10 + (c - '0');
+  }
+  for(int i = decimals < 0 ? 0 : decimals; i < sym.precision(); i++){
+    check(amount <= asset::max_amount / 10, "Memo amount out of range.");
+    amount *= 10;
+  }
+  check(amount > 0, "Memo amount must be greater then zero.");
+  return amount;
+}
+
+/**
+ * Splits an incoming transfer over the member accounts listed in the memo, ie alice=10,bob=5.5
+ * The amounts are in token units and must add up to the transferred quantity.
+ * 
+ * @param args The account=amount list of the memo
+ * @param quantity The transferred quantity
+ */
+void daclifycore::deposit_many(std::string_view args, const extended_asset& quantity){
+  int64_t total = 0;
+  while(args.size() > 0){
+    size_t end = args.find(',');
+    std::string_view entry = args.substr(0, end);
+    args = end == std::string_view::npos ? std::string_view() : args.substr(end + 1);
+    while(entry.size() > 0 && entry.front() == ' '){
+      entry.remove_prefix(1);
+    }
+    size_t eq = entry.find('=');
+    check(eq != std::string_view::npos, "Invalid memo entry, expected account=amount.");
+    name receiver = name(entry.substr(0, eq) );
+    check(is_member(receiver), "Receiver in memo is not a registered member.");
+    int64_t amount = parse_memo_amount(entry.substr(eq + 1), quantity.quantity.symbol);
+    check(amount <= quantity.quantity.amount - total, "Memo amounts exceed the transferred quantity.");
+    total += amount;
+    add_balance(receiver, extended_asset(amount, quantity.get_extended_symbol() ) );
+  }
+  check(total == quantity.quantity.amount, "Memo amounts don't add up to the transferred quantity.");
 }
 
 /**
@@ -283,6 +830,155 @@ void daclifycore::update_active() {
  * 
  */
 void daclifycore::sub_balance( const name& account, const extended_asset& value) {
+  if(!is_balance_scope_migrated(account) ){
+    sub_legacy_balance(account, value);
+    return;
+  }
+
+  tokenbals_table _tokenbals( get_self(), account.value);
+  const auto& itr = _tokenbals.get( get_balance_key(value.get_extended_symbol() ), "No balance with this symbol and contract.");
+  check( itr.balance.get_extended_symbol() == value.get_extended_symbol(), "No balance with this symbol and contract.");
+  check( itr.balance >= value, "Overdrawn balance");
+
+  if(account != get_self() && itr.balance == value){
+    _tokenbals.erase(itr);
+    return;
+  }
+
+  _tokenbals.modify( itr, same_payer, [&]( auto& a) {
+     a.balance -= value;
+  });
+}
+
+/**
+ * Adds the balance of the `extended_asset` to the balances of the account
+ * 
+ * @param account The account to add the balance to.
+ * @param value The amount of the asset to add to the balance.
+ */
+void daclifycore::add_balance( const name& account, const extended_asset& value){
+  if(!is_balance_scope_migrated(account) ){
+    add_legacy_balance(account, value);
+    return;
+  }
+
+  tokenbals_table _tokenbals( get_self(), account.value);
+  uint64_t key = get_balance_key(value.get_extended_symbol() );
+  auto itr = _tokenbals.find(key);
+
+  if( itr == _tokenbals.end() ) {
+    _tokenbals.emplace( get_self(), [&]( auto& a){
+      a.key = key;
+      a.balance = value;
+    });
+  } 
+  else {
+    check( itr->balance.get_extended_symbol() == value.get_extended_symbol(), "Balance key collision.");
+    _tokenbals.modify( itr, same_payer, [&]( auto& a) {
+      a.balance += value;
+    });
+  }
+}
+
+/**
+ * Returns the balance of an account for a token in either balances layout
+ * 
+ * @param account The scope of the balances
+ * @param sym The extended symbol of the token
+ * 
+ * @return The balance, zero if the account has no balance for the token.
+ */
+extended_asset daclifycore::get_balance(const name& account, const extended_symbol& sym){
+  if(is_balance_scope_migrated(account) ){
+    tokenbals_table _tokenbals( get_self(), account.value);
+    auto itr = _tokenbals.find(get_balance_key(sym) );
+    if(itr != _tokenbals.end() && itr->balance.get_extended_symbol() == sym){
+      return itr->balance;
+    }
+  }
+  else{
+    balances_table _balances( get_self(), account.value);
+    auto by_contr_sym = _balances.get_index<"bycontrsym"_n>(); 
+    auto itr = by_contr_sym.find( (uint128_t{sym.get_contract().value} << 64) | sym.get_symbol().raw() );
+    if(itr != by_contr_sym.end() ){
+      return itr->balance;
+    }
+  }
+  return extended_asset(0, sym);
+}
+
+/**
+ * Derives the tokenbals primary key of a token from the first 8 bytes of sha256(contract, symbol)
+ * 
+ * @param sym The extended symbol of the token
+ * 
+ * @return The primary key.
+ */
+uint64_t daclifycore::get_balance_key(const extended_symbol& sym){
+  uint64_t raw[2] = {sym.get_contract().value, sym.get_symbol().raw()};
+  auto hash = sha256(reinterpret_cast<const char*>(raw), sizeof(raw) ).extract_as_byte_array();
+  uint64_t key = 0;
+  for(int i = 0; i < 8; i++){
+    key = (key << 8) | hash[i];
+  }
+  return key;
+}
+
+/**
+ * Checks if the balances of an account are in the tokenbals layout. Scopes are migrated in order, the
+ * group scope first and then the members by account name.
+ * 
+ * @param account The scope of the balances
+ * 
+ * @return true if the scope uses tokenbals, false if it still uses the legacy balances table
+ */
+bool daclifycore::is_balance_scope_migrated(const name& account){
+  const fullstate& state = get_group_state();
+  if(state.balances_migrated){
+    return true;
+  }
+  if(account == get_self() ){
+    return state.balance_migration_cursor != 0;
+  }
+  return account.value < state.balance_migration_cursor;
+}
+
+/**
+ * Moves all legacy balances rows of an account into the tokenbals table
+ * 
+ * @param account The scope to migrate
+ */
+void daclifycore::migrate_balance_scope(const name& account){
+  balances_table _balances( get_self(), account.value);
+  tokenbals_table _tokenbals( get_self(), account.value);
+  auto itr = _balances.begin();
+  while(itr != _balances.end() ) {
+    uint64_t key = get_balance_key(itr->balance.get_extended_symbol() );
+    auto bal_itr = _tokenbals.find(key);
+    if(bal_itr == _tokenbals.end() ){
+      _tokenbals.emplace( get_self(), [&]( auto& a){
+        a.key = key;
+        a.balance = itr->balance;
+      });
+    }
+    else{
+      check( bal_itr->balance.get_extended_symbol() == itr->balance.get_extended_symbol(), "Balance key collision.");
+      _tokenbals.modify( bal_itr, same_payer, [&]( auto& a) {
+        a.balance += itr->balance;
+      });
+    }
+    itr = _balances.erase(itr);
+  }
+}
+
+/**
+ * Subtracts the asset value from the balance of the account in the legacy balances layout
+ * 
+ * @param account The account to debit
+ * @param value The amount of the (extended) asset to be subtracted from the balance.
+ * 
+ */
+void daclifycore::sub_legacy_balance( const name& account, const extended_asset& value) {
 
    balances_table _balances( get_self(), account.value);
    auto by_contr_sym = _balances.get_index<"bycontrsym"_n>(); 
@@ -304,12 +1000,12 @@ void daclifycore::sub_balance( const name& account, const extended_asset& value)
 
 
 /**
- * Adds the balance of the `extended_asset` to the `balances_table` of the account
+ * Adds the balance of the `extended_asset` to the legacy `balances_table` of the account
  * 
  * @param account The account to add the balance to.
  * @param value The amount of the asset to add to the balance.
  */
-void daclifycore::add_balance( const name& account, const extended_asset& value){
+void daclifycore::add_legacy_balance( const name& account, const extended_asset& value){
   //uint128_t composite_id = (uint128_t{value.contract.value} << 64) | value.quantity.symbol.raw();
    balances_table _balances( get_self(), account.value);
    auto by_contr_sym = _balances.get_index<"bycontrsym"_n>(); 
@@ -337,7 +1033,6 @@ void daclifycore::add_balance( const name& account, const extended_asset& value)
  * @return true if the threshold name exists
  */
 bool daclifycore::is_existing_threshold_name(const name& threshold_name){
-  thresholds_table _thresholds(get_self(), get_self().value);
   auto thresh_itr = _thresholds.find(threshold_name.value);
   if(thresh_itr == _thresholds.end() ){
     return false;
@@ -348,7 +1043,7 @@ bool daclifycore::is_existing_threshold_name(const name& threshold_name){
 }
 
 /**
- * If the threshold_name is found in the thresholds table, return the threshold value. If not, return
+ * If the threshold_name is found in the compiled threshold policy, return the threshold value. If not, return
  * the default threshold value
  * 
  * @param threshold_name The name of the threshold to look for.
@@ -356,14 +1051,15 @@ bool daclifycore::is_existing_threshold_name(const name& threshold_name){
  * @return The threshold value for the given threshold name, or default threshold if not found.
  */
 uint8_t daclifycore::get_threshold_by_name(const name& threshold_name){
-  thresholds_table _thresholds(get_self(), get_self().value);
-  auto thresh_itr = _thresholds.find(threshold_name.value);
-  if(thresh_itr == _thresholds.end() ){
-    return get_threshold_by_name(name("default"));
-  }
-  else{
+  const threshpolicy& policy = get_threshold_policy();
+  auto thresh_itr = std::lower_bound(policy.thresholds.begin(), policy.thresholds.end(), threshold_name, [](const policythreshold& t, const name& n){
+    return t.threshold_name < n;
+  });
+  if(thresh_itr != policy.thresholds.end() && thresh_itr->threshold_name == threshold_name){
     return thresh_itr->threshold;
   }
+  check(threshold_name != name("default"), "Default threshold not set.");
+  return get_threshold_by_name(name("default"));
 }
 
 /**
@@ -377,7 +1073,6 @@ uint8_t daclifycore::get_threshold_by_name(const name& threshold_name){
  * @return a vector of the custodians that are linked to the threshold.
  */
 void daclifycore::insert_or_update_or_delete_threshold(const name& threshold_name, const int8_t& threshold, const bool& remove, const bool& privileged){
-   thresholds_table _thresholds(get_self(), get_self().value);
    auto thresh_itr = _thresholds.find(threshold_name.value);
 
    bool is_linked = is_threshold_linked(threshold_name);
@@ -387,6 +1082,7 @@ void daclifycore::insert_or_update_or_delete_threshold(const name& threshold_nam
       check(thresh_itr != _thresholds.end(), "Can't remove non existing thresholdname.");
       check(threshold_name != name("default"), "Can't delete the default threshold."); //!!!!!!!!!!!!!!
       _thresholds.erase(thresh_itr);
+      _policy_dirty = true;
       //assert when last threshold?
       return;
    }
@@ -418,6 +1114,7 @@ void daclifycore::insert_or_update_or_delete_threshold(const name& threshold_nam
         a.threshold = threshold;
       });
    }
+   _policy_dirty = true;
 }
 
 /**
@@ -429,7 +1126,6 @@ void daclifycore::insert_or_update_or_delete_threshold(const name& threshold_nam
  * @return a boolean value.
  */
 bool daclifycore::is_threshold_linked(const name& threshold_name){
-  threshlinks_table _threshlinks(get_self(), get_self().value);
   auto by_threshold = _threshlinks.get_index<"bythreshold"_n>(); 
   auto link_itr = by_threshold.find(threshold_name.value);
   if(link_itr == by_threshold.end() ){
@@ -450,36 +1146,76 @@ bool daclifycore::is_threshold_linked(const name& threshold_name){
  * @return A struct containing the name of the threshold and the value of the threshold.
  */
 daclifycore::threshold_name_and_value daclifycore::get_required_threshold_name_and_value_for_contract_action(const name& contract, const name& action_name){
-  
-  threshlinks_table _threshlinks(get_self(), get_self().value);
-  auto by_cont_act = _threshlinks.get_index<"bycontact"_n>();
-  uint128_t composite_id = (uint128_t{contract.value} << 64) | action_name.value;
-  auto link_itr = by_cont_act.find(composite_id);
 
-  if(link_itr != by_cont_act.end() ){
-    //there is a FULL MATCH
-    return threshold_name_and_value{link_itr->threshold_name, get_threshold_by_name(link_itr->threshold_name ) };
+  //full match, then action name linked, then contract linked
+  const policylink* link = find_policy_link(contract, action_name);
+  if(link == nullptr){
+    link = find_policy_link(name(0), action_name);
   }
-  else{
-    //check if the action name is linked
-    link_itr = by_cont_act.find((uint128_t{name(0).value} << 64) | action_name.value);
-    if(link_itr != by_cont_act.end() ){
-      //action name is linked
-      return threshold_name_and_value{link_itr->threshold_name, get_threshold_by_name(link_itr->threshold_name ) };
-    }
-    else{
-      //check if contract is linked
-      link_itr = by_cont_act.find((uint128_t{contract.value} << 64) | name(0).value);
-      if(link_itr != by_cont_act.end() ){
-        //contract is linked
-        return threshold_name_and_value{link_itr->threshold_name, get_threshold_by_name(link_itr->threshold_name ) };
-      }
-      else{
-        //NO MATCH -> return default
-        return threshold_name_and_value{name("default"), get_threshold_by_name(name("default") ) };
-      }
-    }
+  if(link == nullptr){
+    link = find_policy_link(contract, name(0) );
+  }
+  if(link != nullptr){
+    return threshold_name_and_value{link->threshold_name, get_threshold_by_name(link->threshold_name ) };
+  }
+  //NO MATCH -> return default
+  return threshold_name_and_value{name("default"), get_threshold_by_name(name("default") ) };
+}
+
+/**
+ * Binary search for a threshold link in the compiled threshold policy
+ * 
+ * @param contract the name of the contract, name(0) for the action wildcard
+ * @param action_name the name of the action, name(0) for the contract wildcard
+ * 
+ * @return pointer to the link or nullptr if not linked
+ */
+const daclifycore::policylink* daclifycore::find_policy_link(const name& contract, const name& action_name){
+  const threshpolicy& policy = get_threshold_policy();
+  auto link_itr = std::lower_bound(policy.links.begin(), policy.links.end(), std::make_pair(contract, action_name), [](const policylink& l, const std::pair<name, name>& key){
+    return l.contract < key.first || (l.contract == key.first && l.action_name < key.second);
+  });
+  if(link_itr != policy.links.end() && link_itr->contract == contract && link_itr->action_name == action_name){
+    return &(*link_itr);
   }
+  return nullptr;
+}
+
+/**
+ * Returns the compiled threshold policy, read once per action. The policy is (re)compiled when it
+ * doesn't exist yet or when thresholds or links changed during this action.
+ * 
+ * @return The threshold policy.
+ */
+const daclifycore::threshpolicy& daclifycore::get_threshold_policy(){
+  if(_policy_dirty || (!_policy && !_threshpolicy.exists() ) ){
+    compile_threshold_policy();
+  }
+  else if(!_policy){
+    _policy = _threshpolicy.get();
+  }
+  return *_policy;
+}
+
+/**
+ * Compiles the thresholds and threshlinks tables into the threshpolicy singleton and bumps its version
+ */
+void daclifycore::compile_threshold_policy(){
+  threshpolicy policy;
+  policy.version = ++modify_group_state().policy_version;
+  //primary key order is threshold name order
+  for(auto itr = _thresholds.begin(); itr != _thresholds.end(); itr++){
+    policy.thresholds.push_back(policythreshold{itr->threshold_name, itr->threshold});
+  }
+  for(auto itr = _threshlinks.begin(); itr != _threshlinks.end(); itr++){
+    policy.links.push_back(policylink{itr->contract, itr->action_name, itr->threshold_name});
+  }
+  std::sort(policy.links.begin(), policy.links.end(), [](const policylink& a, const policylink& b){
+    return a.contract < b.contract || (a.contract == b.contract && a.action_name < b.action_name);
+  });
+  _threshpolicy.set(policy, get_self() );
+  _policy = policy;
+  _policy_dirty = false;
 }
 
 
@@ -492,73 +1228,334 @@ daclifycore::threshold_name_and_value daclifycore::get_required_threshold_name_a
  * @return The total weight of all the approved custodians for a given proposal.
  */
 uint8_t daclifycore::get_total_approved_proposal_weight(proposals_table::const_iterator& prop_itr){
+  uint64_t approvals = prop_itr->approvals;
+  return tally_approvals(approvals, prop_itr->tally_epoch);
+}
+
+/**
+ * Clears the approval bits of slots that were freed or reassigned after the approvals were validated
+ * and sums the weight of the remaining approvers
+ * 
+ * @param approvals The approvals bitmap, stale bits are cleared
+ * @param validated_epoch The custodian epoch in which the approvals were last validated
+ * 
+ * @return The total weight of the valid approvals.
+ */
+uint8_t daclifycore::tally_approvals(uint64_t& approvals, const uint32_t& validated_epoch){
   uint8_t total_weight = 0;
-  if(prop_itr->approvals.size()==0){
-    return total_weight;
+  auto by_slot = _custodians.get_index<"byslot"_n>();
+  uint64_t bits = approvals;
+  while(bits != 0){
+    uint8_t slot = __builtin_ctzll(bits);
+    bits &= bits - 1;
+    auto cust_itr = by_slot.find(slot);
+    if(cust_itr != by_slot.end() && cust_itr->slot_epoch <= validated_epoch){
+      total_weight += cust_itr->weight;
+    }
+    else{
+      approvals &= ~(uint64_t(1) << slot);
+    }
   }
-  else{
-    custodians_table _custodians(get_self(), get_self().value);
-    
-    for(name approver : prop_itr->approvals){
-      auto cust_itr = _custodians.find(approver.value);
-      if(cust_itr != _custodians.end() ){
-        total_weight += cust_itr->weight;
+  return total_weight;
+}
+
+/**
+ * Resolves an approvals bitmap to the accounts that hold the slots, approvals of slots that were freed
+ * or reassigned after the approvals were validated are left out
+ * 
+ * @param approvals The approvals bitmap
+ * @param validated_epoch The custodian epoch in which the approvals were last validated
+ * 
+ * @return The approving custodians in slot order.
+ */
+vector<name> daclifycore::get_approvers(const uint64_t& approvals, const uint32_t& validated_epoch){
+  vector<name> approvers;
+  auto by_slot = _custodians.get_index<"byslot"_n>();
+  uint64_t bits = approvals;
+  while(bits != 0){
+    uint8_t slot = __builtin_ctzll(bits);
+    bits &= bits - 1;
+    auto cust_itr = by_slot.find(slot);
+    if(cust_itr != by_slot.end() && cust_itr->slot_epoch <= validated_epoch){
+      approvers.push_back(cust_itr->account);
+    }
+  }
+  return approvers;
+}
+
+/**
+ * Adds the approval of a custodian to a proposal. With exec_on_threshold_reached the approval that
+ * reaches the required threshold executes and archives the proposal right away.
+ * 
+ * @param id The proposal id
+ * @param approver The custodian row of the approver
+ * 
+ * @return True if the proposal was executed.
+ */
+bool daclifycore::approve_proposal(const uint64_t& id, const custodians& approver){
+  auto prop_itr = _proposals.find(id);
+  check(prop_itr != _proposals.end(), "Proposal not found.");
+  uint64_t approver_bit = uint64_t(1) << approver.slot;
+  _proposals.modify( prop_itr, same_payer, [&]( auto& n) {
+      //clean out non/old custodians only when the custodian set changed
+      refresh_approval_tally(n);
+      check(!(n.approvals & approver_bit), "You already approved this proposal.");
+      n.approvals |= approver_bit;
+      n.approved_weight += approver.weight;
+      n.last_actor = approver.account;
+  });
+
+  if(!get_group_conf().exec_on_threshold_reached){
+    return false;
+  }
+  //the tally is fresh after the modify, an expired proposal is left for purge/cancel
+  if(time_point_sec(current_time_point() ) >= prop_itr->expiration || prop_itr->approved_weight < get_proposal_threshold(*prop_itr) ){
+    return false;
+  }
+  execute_proposal(prop_itr);
+  return true;
+}
+
+/**
+ * Removes the approval of a custodian from a proposal
+ * 
+ * @param id The proposal id
+ * @param unapprover The custodian row of the unapprover
+ */
+void daclifycore::unapprove_proposal(const uint64_t& id, const custodians& unapprover){
+  auto prop_itr = _proposals.find(id);
+  check(prop_itr != _proposals.end(), "Proposal not found.");
+  uint64_t unapprover_bit = uint64_t(1) << unapprover.slot;
+  _proposals.modify( prop_itr, same_payer, [&]( auto& n) {
+      //clean out non/old custodians only when the custodian set changed
+      refresh_approval_tally(n);
+      check(n.approvals & unapprover_bit, "You are not in the list of approvals.");
+      n.approvals &= ~unapprover_bit;
+      n.approved_weight -= unapprover.weight;
+      n.last_actor = unapprover.account;
+  });
+}
+
+/**
+ * Returns the approved weight of a proposal. The running tally is used when it is still valid for the
+ * current custodian set, otherwise the weight is recomputed from the approvals.
+ * 
+ * @param prop_itr The proposal iterator
+ * 
+ * @return The total weight of all the approved custodians for the proposal.
+ */
+uint8_t daclifycore::get_approved_weight(proposals_table::const_iterator& prop_itr){
+  if(prop_itr->tally_epoch == get_group_state().cust_epoch){
+    return prop_itr->approved_weight;
+  }
+  return get_total_approved_proposal_weight(prop_itr);
+}
+
+/**
+ * Recomputes the approval tally of a proposal when the custodian set changed since the last tally.
+ * Approvals of accounts that are no longer custodian are dropped.
+ * 
+ * @param prop The proposal row, must be called from within a modify
+ */
+void daclifycore::refresh_approval_tally(proposals& prop){
+  uint32_t cust_epoch = get_group_state().cust_epoch;
+  if(prop.tally_epoch == cust_epoch){
+    return;
+  }
+  prop.approved_weight = tally_approvals(prop.approvals, prop.tally_epoch);
+  prop.tally_epoch = cust_epoch;
+}
+
+/**
+ * Invalidates the approval tallies of all proposals by bumping the custodian epoch, must be called when
+ * the custodian set changes. Proposals record the epoch their approvals were validated at and are only
+ * cleaned of stale approvers when touched in a later epoch, so votes in a stable council need no
+ * custodian lookups for the earlier approvers.
+ */
+void daclifycore::invalidate_approval_tallies(){
+  modify_group_state().cust_epoch++;
+}
+
+/**
+ * Returns the threshold value a proposal needs for execution. The value resolved at propose time is used
+ * until the thresholds or links change.
+ * 
+ * @param prop The proposal row
+ * 
+ * @return The required threshold value.
+ */
+uint8_t daclifycore::get_proposal_threshold(const proposals& prop){
+  if(prop.policy_version == get_group_state().policy_version){
+    return prop.required_threshold_value;
+  }
+  return get_threshold_by_name(prop.required_threshold);
+}
+
+/**
+ * Sends the actions of a proposal and archives it as executed. The caller must have verified the
+ * expiration and the approved weight and set the last_actor.
+ * 
+ * @param prop_itr the iterator to the proposal to be executed
+ */
+void daclifycore::execute_proposal(proposals_table::const_iterator& prop_itr){
+  const propbodies& body = _propbodies.get(prop_itr->id, "Proposal body not found.");
+  send_proposal_actions(body.actions);
+  archive_proposal(name("executed"), _proposals, prop_itr);
+}
+
+/**
+ * Sends the actions of an approved proposal
+ * 
+ * @param actions The proposal actions
+ */
+void daclifycore::send_proposal_actions(const vector<action>& actions){
+  for(const action& act : actions) { 
+      if(act.account == name("eosio") && act.name == name("updateauth") ){
+        //the active authority may be changed outside update_active, force the next publish
+        modify_group_state().active_auth_hash = checksum256();
       }
+      send_action(act);
+  }
+}
+
+/**
+ * Validates the actions of a proposal and resolves the highest threshold required to execute them
+ * 
+ * @param actions The proposal actions
+ * 
+ * @return The name and value of the highest required threshold.
+ */
+daclifycore::threshold_name_and_value daclifycore::get_max_required_threshold(const vector<action>& actions){
+  check(actions.size() > 0 && actions.size() < 8, "Number of actions not allowed.");
+
+  threshold_name_and_value max_required_threshold;
+  for (std::vector<int>::size_type i = 0; i != actions.size(); i++){
+    if(actions[i].account == get_self() ){
+      check(actions[i].name != name("propose"), "can't propose a proposal on self.");
+      check(actions[i].name != name("execsigned"), "can't propose a signed execution on self.");
+    }
+    threshold_name_and_value tnav = get_required_threshold_name_and_value_for_contract_action(actions[i].account, actions[i].name);
+    check(tnav.threshold >= 0, "Action "+actions[i].name.to_string()+" is blocked via negative threshold");
+    if(i==0){
+      max_required_threshold = tnav;
+    }
+    else if(tnav.threshold > max_required_threshold.threshold){
+      max_required_threshold = tnav;
     }
-    return total_weight;
   }
+  return max_required_threshold;
 }
 
 /**
- * It archives a proposal by moving it from the active proposals table to the history table
+ * It archives a proposal as a lean proparchive row in a ring of proposal_archive_size slots in the
+ * archive scope and erases the open proposal. When the ring is full the oldest archived proposal is
+ * overwritten in place.
  * 
- * @param archive_type The name of the table to archive the proposal from.
+ * @param archive_type The name of the archive scope (executed or cancelled).
  * @param idx the table index to be archived
  * @param prop_itr the iterator to the proposal to be archived
  */
 void daclifycore::archive_proposal(const name& archive_type, proposals_table& idx, proposals_table::const_iterator& prop_itr){
 
-  uint8_t keep_history = get_group_conf().proposal_archive_size;
+  auto body_itr = _propbodies.find(prop_itr->id);
+
+  if(get_group_conf().proposal_archive_size > 0){
+    write_archive_row(archive_type, *prop_itr, body_itr != _propbodies.end() ? &(*body_itr) : nullptr);
+  }
+  if(body_itr != _propbodies.end() ){
+    _propbodies.erase(body_itr);
+  }
+  idx.erase(prop_itr);
 
-  if(keep_history > 0){
-
-    proposals_table h_proposals(get_self(), archive_type.value);
-    auto end_itr = h_proposals.end();
-
-    if(h_proposals.begin() != end_itr ){//there are entries in the table
-      end_itr--;
-      uint64_t count = ( end_itr->id - h_proposals.begin()->id ) +1;
-      
-      if(count >= keep_history){
-        //h_proposals.erase(h_proposals.begin() );
-
-        uint32_t batch_size = 1;
-        action(
-            permission_level{ get_self(), "owner"_n },
-            get_self(),
-            "trunchistory"_n,
-            std::make_tuple(archive_type, batch_size)
-        ).send();
-      }   
+}
+
+/**
+ * Writes a proposal into the next slot of the archive ring of an archive type, the oldest archived
+ * proposal is overwritten in place when the ring is full. Requires proposal_archive_size > 0.
+ * 
+ * @param archive_type The name of the archive scope (executed, expired or cancelled).
+ * @param prop The proposal header
+ * @param body The proposal body, nullptr if the proposal has no body
+ */
+void daclifycore::write_archive_row(const name& archive_type, const proposals& prop, const propbodies* body){
+
+  uint8_t keep_history = get_group_conf().proposal_archive_size;
+  uint64_t& archived_count = get_archive_counter(archive_type);
+  uint64_t slot = archived_count % keep_history;
+  archived_count++;
+  //slots are reassigned when the council changes, the archive keeps the approvers by name
+  vector<name> approvers = get_approvers(prop.approvals, prop.tally_epoch);
+
+  auto archive = [&](auto& n) {
+    n.id = slot;
+    n.proposal_id = prop.id;
+    n.proposer = prop.proposer;
+    n.outcome = archive_type;
+    n.approvals = approvers;
+    n.last_actor = prop.last_actor;
+    n.submitted = prop.submitted;
+    n.expiration = prop.expiration;
+    n.archived = time_point_sec(current_time_point() );
+    n.trx_id = checksum256();
+    n.actions_hash = checksum256();
+    if(body != nullptr){
+      auto packed_actions = pack(body->actions);
+      n.trx_id = body->trx_id;
+      n.actions_hash = sha256(packed_actions.data(), packed_actions.size() );
     }
+  };
 
-    h_proposals.emplace(get_self(), [&](auto& n) {
-      n.id = h_proposals.available_primary_key();
-      n.proposer = prop_itr->proposer;
-      n.actions = prop_itr->actions;
-      n.approvals = prop_itr->approvals;
-      n.expiration = prop_itr->expiration;
-      n.submitted = prop_itr->submitted;
-      n.description = prop_itr->description;
-      n.title = prop_itr->title;
-      n.last_actor = prop_itr->last_actor;
-      n.required_threshold = prop_itr->required_threshold;
-      n.trx_id = prop_itr->trx_id;
-    });
+  proparchive_table _proparchive(get_self(), archive_type.value);
+  auto h_itr = _proparchive.find(slot);
+  if(h_itr == _proparchive.end() ){
+    _proparchive.emplace(get_self(), archive);
+  }
+  else{
+    _proparchive.modify(h_itr, same_payer, archive);
+  }
+
+}
 
+/**
+ * Returns the counter of archived proposals of an archive type
+ * 
+ * @param archive_type The name of the archive scope (executed, cancelled or expired).
+ * 
+ * @return Reference to the counter in the group state.
+ */
+uint64_t& daclifycore::get_archive_counter(const name& archive_type){
+  fullstate& state = modify_group_state();
+  if(archive_type == name("executed") ){
+    return state.executed_count;
   }
-  idx.erase(prop_itr);
+  if(archive_type == name("expired") ){
+    return state.expired_count;
+  }
+  check(archive_type == name("cancelled"), "Unknown archive type.");
+  return state.cancelled_count;
+}
 
+/**
+ * Archives expired proposals, oldest expiration first
+ * 
+ * @param max_rows The maximum number of proposals to archive.
+ * 
+ * @return The number of archived proposals.
+ */
+uint32_t daclifycore::purge_expired_proposals(const uint32_t& max_rows){
+  time_point_sec now = time_point_sec(current_time_point() );
+  auto by_expiration = _proposals.get_index<"byexpiration"_n>();
+  uint32_t counter = 0;
+  while(counter < max_rows){
+    auto exp_itr = by_expiration.begin();
+    if(exp_itr == by_expiration.end() || exp_itr->expiration > now){
+      break;
+    }
+    auto prop_itr = _proposals.find(exp_itr->id);
+    archive_proposal(name("expired"), _proposals, prop_itr);
+    counter++;
+  }
+  return counter;
 }
 
 
@@ -0,0 +1,232 @@
+/**
+ * Opt-in resource accounting, enabled by compiling with -DRESOURCE_STATS.
+ *
+ * metered_multi_index and metered_singleton count finds, emplaces, modifies and erases per table
+ * and estimate the billable RAM added or freed. Inline actions are counted through track_inline.
+ * Without RESOURCE_STATS the wrappers are plain aliases and all tracking compiles away.
+ */
+namespace resourcestats {
+
+  //billable overhead the chain adds per row and per secondary index entry
+  static constexpr int64_t ROW_OVERHEAD_BYTES = 112;
+  static constexpr int64_t IDX64_OVERHEAD_BYTES = 128;
+  static constexpr int64_t IDX128_OVERHEAD_BYTES = 144;
+
+  struct tableops {
+    eosio::name table;
+    uint64_t finds = 0;
+    uint64_t emplaces = 0;
+    uint64_t modifies = 0;
+    uint64_t erases = 0;
+    int64_t ram_delta = 0;
+  };
+
+  struct tracker {
+    eosio::name action_name;
+    std::vector<tableops> tables;
+    uint64_t inline_actions = 0;
+    uint64_t inline_bytes = 0;
+    uint64_t hook_dispatches = 0;
+
+    tableops& of(const eosio::name& table){
+      for(tableops& t : tables){
+        if(t.table == table){
+          return t;
+        }
+      }
+      tables.push_back(tableops{table});
+      return tables.back();
+    }
+
+    int64_t ram_delta() const {
+      int64_t delta = 0;
+      for(const tableops& t : tables){
+        delta += t.ram_delta;
+      }
+      return delta;
+    }
+  };
+
+  inline tracker& current(){
+    static tracker t;
+    return t;
+  }
+
+#ifdef RESOURCE_STATS
+
+  inline void begin(const eosio::name& action_name){
+    current() = tracker();
+    current().action_name = action_name;
+  }
+
+  inline void track_inline(const eosio::action& act){
+    current().inline_actions++;
+    current().inline_bytes += eosio::pack_size(act);
+  }
+
+  inline void track_hook(const eosio::action& act){
+    track_inline(act);
+    current().hook_dispatches++;
+  }
+
+  template<typename Index>
+  constexpr int64_t index_overhead(){
+    return sizeof(typename Index::secondary_extractor_type::result_type) > 8 ? IDX128_OVERHEAD_BYTES : IDX64_OVERHEAD_BYTES;
+  }
+
+  template<eosio::name::raw TableName, typename T, typename... Indices>
+  class metered_multi_index : public eosio::multi_index<TableName, T, Indices...> {
+    public:
+      typedef eosio::multi_index<TableName, T, Indices...> base;
+      using typename base::const_iterator;
+      using base::base;
+
+      static int64_t row_ram(const T& obj){
+        return int64_t(eosio::pack_size(obj) ) + ROW_OVERHEAD_BYTES + (int64_t(0) + ... + index_overhead<Indices>() );
+      }
+
+      static tableops& ops(){
+        return current().of(eosio::name(TableName) );
+      }
+
+      //secondary index lookups and writes are booked on the table they belong to
+      template<typename Index>
+      struct metered_index : public Index {
+        metered_index(const Index& idx) : Index(idx) {}
+
+        template<typename K>
+        auto find(const K& secondary) const { ops().finds++; return Index::find(secondary); }
+        template<typename K>
+        auto lower_bound(const K& secondary) const { ops().finds++; return Index::lower_bound(secondary); }
+        template<typename K>
+        auto upper_bound(const K& secondary) const { ops().finds++; return Index::upper_bound(secondary); }
+        template<typename K>
+        const T& get(const K& secondary, const char* error_msg = "unable to find secondary key") const {
+          ops().finds++;
+          return Index::get(secondary, error_msg);
+        }
+        auto begin() const { ops().finds++; return Index::begin(); }
+
+        template<typename Iterator, typename Lambda>
+        void modify(Iterator itr, eosio::name payer, Lambda&& updater){
+          int64_t before = int64_t(eosio::pack_size(*itr) );
+          Index::modify(itr, payer, std::forward<Lambda>(updater) );
+          ops().modifies++;
+          ops().ram_delta += int64_t(eosio::pack_size(*itr) ) - before;
+        }
+        template<typename Iterator>
+        auto erase(Iterator itr){
+          ops().erases++;
+          ops().ram_delta -= row_ram(*itr);
+          return Index::erase(itr);
+        }
+      };
+
+      const_iterator find(uint64_t primary) const { ops().finds++; return base::find(primary); }
+      const_iterator require_find(uint64_t primary, const char* error_msg = "unable to find key") const {
+        ops().finds++;
+        return base::require_find(primary, error_msg);
+      }
+      const T& get(uint64_t primary, const char* error_msg = "unable to find key") const {
+        ops().finds++;
+        return base::get(primary, error_msg);
+      }
+      const_iterator lower_bound(uint64_t primary) const { ops().finds++; return base::lower_bound(primary); }
+      const_iterator upper_bound(uint64_t primary) const { ops().finds++; return base::upper_bound(primary); }
+      const_iterator begin() const { ops().finds++; return base::begin(); }
+
+      template<typename Lambda>
+      const_iterator emplace(eosio::name payer, Lambda&& constructor){
+        const_iterator itr = base::emplace(payer, std::forward<Lambda>(constructor) );
+        ops().emplaces++;
+        ops().ram_delta += row_ram(*itr);
+        return itr;
+      }
+      template<typename Lambda>
+      void modify(const_iterator itr, eosio::name payer, Lambda&& updater){
+        int64_t before = int64_t(eosio::pack_size(*itr) );
+        base::modify(itr, payer, std::forward<Lambda>(updater) );
+        ops().modifies++;
+        ops().ram_delta += int64_t(eosio::pack_size(*itr) ) - before;
+      }
+      template<typename Lambda>
+      void modify(const T& obj, eosio::name payer, Lambda&& updater){
+        modify(base::iterator_to(obj), payer, std::forward<Lambda>(updater) );
+      }
+      const_iterator erase(const_iterator itr){
+        ops().erases++;
+        ops().ram_delta -= row_ram(*itr);
+        return base::erase(itr);
+      }
+      void erase(const T& obj){
+        erase(base::iterator_to(obj) );
+      }
+
+      template<eosio::name::raw IndexName>
+      auto get_index(){
+        auto idx = base::template get_index<IndexName>();
+        return metered_index<decltype(idx)>(idx);
+      }
+      template<eosio::name::raw IndexName>
+      auto get_index() const {
+        auto idx = base::template get_index<IndexName>();
+        return metered_index<decltype(idx)>(idx);
+      }
+  };
+
+  template<eosio::name::raw SingletonName, typename T>
+  class metered_singleton : public eosio::singleton<SingletonName, T> {
+    public:
+      typedef eosio::singleton<SingletonName, T> base;
+      using base::base;
+
+      static tableops& ops(){
+        return current().of(eosio::name(SingletonName) );
+      }
+
+      bool exists(){ ops().finds++; return base::exists(); }
+      T get(){ ops().finds++; return base::get(); }
+      T get_or_default(const T& def = T() ){ ops().finds++; return base::get_or_default(def); }
+      T get_or_create(eosio::name payer, const T& def = T() ){
+        ops().finds++;
+        if(!base::exists() ){
+          ops().emplaces++;
+          ops().ram_delta += int64_t(eosio::pack_size(def) ) + ROW_OVERHEAD_BYTES;
+        }
+        return base::get_or_create(payer, def);
+      }
+      void set(const T& value, eosio::name payer){
+        if(base::exists() ){
+          ops().modifies++;
+          ops().ram_delta += int64_t(eosio::pack_size(value) ) - int64_t(eosio::pack_size(base::get() ) );
+        }
+        else{
+          ops().emplaces++;
+          ops().ram_delta += int64_t(eosio::pack_size(value) ) + ROW_OVERHEAD_BYTES;
+        }
+        base::set(value, payer);
+      }
+      void remove(){
+        if(base::exists() ){
+          ops().erases++;
+          ops().ram_delta -= int64_t(eosio::pack_size(base::get() ) ) + ROW_OVERHEAD_BYTES;
+        }
+        base::remove();
+      }
+  };
+
+#else
+
+  inline void begin(const eosio::name& action_name){}
+  inline void track_inline(const eosio::action& act){}
+  inline void track_hook(const eosio::action& act){}
+
+  template<eosio::name::raw TableName, typename T, typename... Indices>
+  using metered_multi_index = eosio::multi_index<TableName, T, Indices...>;
+
+  template<eosio::name::raw SingletonName, typename T>
+  using metered_singleton = eosio::singleton<SingletonName, T>;
+
+#endif
+
+}
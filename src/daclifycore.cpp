@@ -12,19 +12,31 @@
  * @return The action is returning nothing.
  */
 ACTION daclifycore::updateconf(groupconf new_conf, bool remove){
-    require_auth(get_self());
+  require_auth(get_self());
 
-    coreconf_table _coreconf(get_self(), get_self().value);
-    if(remove){
-      _coreconf.remove();
-      return;
-    }
-    auto conf = _coreconf.get_or_default(coreconf());
-    if(conf.conf.maintainer_account.actor != new_conf.maintainer_account.actor || conf.conf.maintainer_account.permission != new_conf.maintainer_account.permission){
-      update_owner_maintainance(new_conf.maintainer_account);
-    }
-    conf.conf = new_conf;
-    _coreconf.set(conf, get_self());
+  const groupconf& conf = get_group_conf();
+  uint8_t archive_size = remove ? groupconf().proposal_archive_size : new_conf.proposal_archive_size;
+  if(archive_size < conf.proposal_archive_size){
+    //a shrinking archive ring restarts at slot 0, slots beyond the new size are left for trunchistory
+    fullstate& state = modify_group_state();
+    state.executed_count = 0;
+    state.cancelled_count = 0;
+    state.expired_count = 0;
+  }
+  if(remove){
+    set_group_conf(new_conf, true);
+    return;
+  }
+  check(new_conf.hub_notify_mode <= uint8_t(hubmode::recipient), "Invalid hub_notify_mode.");
+  if(conf.maintainer_account.actor != new_conf.maintainer_account.actor || conf.maintainer_account.permission != new_conf.maintainer_account.permission){
+    update_owner_maintainance(new_conf.maintainer_account);
+  }
+  bool timeout_changed = conf.inactivate_cust_after_sec != new_conf.inactivate_cust_after_sec;
+  set_group_conf(new_conf, false);
+  if(timeout_changed){
+    require_upgraded();
+    update_inactive_deadlines();
+  }
 }
 
 
@@ -42,6 +54,7 @@ ACTION daclifycore::updateconf(groupconf new_conf, bool remove){
  */
 ACTION daclifycore::propose(name proposer, string title, string description, vector<action> actions, time_point_sec expiration) {
   require_auth(proposer);
+  require_upgraded();
 
   if(proposer != get_self() ){ //allow get_self to propose
     check(is_custodian(proposer, true, true), "You can't propose group actions because you are not a custodian.");
@@ -49,31 +62,13 @@ ACTION daclifycore::propose(name proposer, string title, string description, vec
   
   time_point_sec now = time_point_sec(current_time_point());
 
-  //validate actions
-  check(actions.size() > 0 && actions.size() < 8, "Number of actions not allowed.");
-
-  //find  max required threshold
-  threshold_name_and_value max_required_threshold;
-  for (std::vector<int>::size_type i = 0; i != actions.size(); i++){
-    if(actions[i].account == get_self() ){
-      check(actions[i].name != name("propose"), "can't propose a proposal on self.");
-    }
-    threshold_name_and_value tnav = get_required_threshold_name_and_value_for_contract_action(actions[i].account, actions[i].name);
-    check(tnav.threshold >= 0, "Action "+actions[i].name.to_string()+" is blocked via negative threshold");
-    if(i==0){
-      max_required_threshold = tnav;
-    }
-    else if(tnav.threshold > max_required_threshold.threshold){
-      max_required_threshold = tnav;
-    }
-  }
+  //validate actions and find max required threshold
+  threshold_name_and_value max_required_threshold = get_max_required_threshold(actions);
 
   groupconf conf = get_group_conf();
   if(max_required_threshold.threshold == 0 && conf.exec_on_threshold_zero ){
     //immediate execution, no signatures needed
-    for(action act : actions) { 
-        act.send();
-    }
+    send_proposal_actions(actions);
     return;
   }
 
@@ -84,60 +79,52 @@ ACTION daclifycore::propose(name proposer, string title, string description, vec
 
   
 
-  vector<name>approvals;
+  uint64_t approvals = 0;
+  uint8_t approved_weight = 0;
   if(proposer != get_self() ){
-    approvals.push_back(proposer);
+    const custodians& cust = _custodians.get(proposer.value);
+    approvals = uint64_t(1) << cust.slot;
+    approved_weight = cust.weight;
   }
   name ram_payer = get_self();
 
-  proposals_table _proposals(get_self(), get_self().value);
+  //opportunistic cleanup so the proposals table can't grow without bound
+  if(conf.purge_expired_on_propose > 0){
+    purge_expired_proposals(conf.purge_expired_on_propose > UINT32_MAX ? UINT32_MAX : uint32_t(conf.purge_expired_on_propose) );
+  }
+
+  uint64_t id = _proposals.available_primary_key();
+  _propbodies.emplace(ram_payer, [&](auto& n) {
+    n.id = id;
+    n.title = title;
+    n.description = description;
+    n.actions = actions;
+    n.trx_id = get_trx_id();
+  });
   _proposals.emplace(ram_payer, [&](auto& n) {
-    n.id = _proposals.available_primary_key();
+    n.id = id;
     n.proposer = proposer;
-    n.actions = actions;
     n.approvals = approvals;
     n.expiration = expiration;
     n.submitted = now;
-    n.description = description;
-    n.title = title;
     n.last_actor = proposer;
-    n.trx_id = get_trx_id();
     n.required_threshold = max_required_threshold.threshold_name;
+    n.required_threshold_value = max_required_threshold.threshold;
+    n.policy_version = get_group_state().policy_version;
+    n.approved_weight = approved_weight;
+    n.tally_epoch = get_group_state().cust_epoch;
   });
 
-  if(true){
-  //messagebus(name sender_group, name event, string message)
-
-    string msg  = "New proposal by "+proposer.to_string();
-    
-    action(
-        permission_level{ get_self(), "owner"_n },
-        conf.hub_account,
-        "messagebus"_n,
-        std::make_tuple(get_self(), name("propose"), msg, vector<name>{} ) //name sender_group, name event, string message, vector<name> receivers
-    ).send();
-    
-  
-/*
-    std::vector<char> data;
-    action(
-        permission_level{ get_self(), "owner"_n },
-        conf.hub_account,
-        "messagebus2"_n,
-        std::make_tuple(get_self(), name("propose"), msg, vector<name>{name("croneosdac22")}, data)
-    ).send();
-
-*/
-    
-  }
+  notify_hub(name("propose"), proposer, id);
 
-  hookmanager(name("propose"), get_self() );
+  hookmanager(name("propose"), id);
 
 }
 
 
 /**
- * approve action adds the approver to the proposal's approvals list, and then calls the hookmanager
+ * approve action adds the approver to the proposal's approvals list, and then calls the hookmanager.
+ * With exec_on_threshold_reached the approval that reaches the threshold also executes the proposal.
  * 
  * @pre requires the authority of the approver
  * 
@@ -146,25 +133,35 @@ ACTION daclifycore::propose(name proposer, string title, string description, vec
  */
 ACTION daclifycore::approve(name approver, uint64_t id) {
   require_auth(approver);
+  require_upgraded();
   check(is_custodian(approver, true, true), "You can't approve because you are not a custodian.");
-  proposals_table _proposals(get_self(), get_self().value);
-  auto prop_itr = _proposals.find(id);
-  check(prop_itr != _proposals.end(), "Proposal not found.");
+  bool executed = approve_proposal(id, _custodians.get(approver.value) );
+  hookmanager(name("approve"), id);
+  if(executed){
+    hookmanager(name("exec"), id);
+  }
+}
 
-  std::set<name> new_approvals{};
-  new_approvals.insert(approver);
-  for (name old_approver: prop_itr->approvals) {
-    //check for dups and clean out non/old custodians.
-    //todo calculate current weight here
-    if(is_custodian(old_approver, false, false)){
-      check(new_approvals.insert(old_approver).second, "You already approved this proposal.");
+/**
+ * approvemany action approves a batch of proposals, the custodian check and activity update are done once
+ * 
+ * @pre requires the authority of the approver
+ * 
+ * @param approver The account that is approving the proposals.
+ * @param ids The proposal ids.
+ */
+ACTION daclifycore::approvemany(name approver, vector<uint64_t> ids) {
+  require_auth(approver);
+  require_upgraded();
+  check(ids.size() > 0, "No proposal ids.");
+  check(is_custodian(approver, true, true), "You can't approve because you are not a custodian.");
+  const custodians& cust = _custodians.get(approver.value);
+  for(uint64_t id : ids){
+    if(approve_proposal(id, cust) ){
+      hookmanager(name("exec"), id);
     }
   }
-  _proposals.modify( prop_itr, same_payer, [&]( auto& n) {
-      n.last_actor = approver;
-      n.approvals = vector<name>(new_approvals.begin(), new_approvals.end() );
-  });
-  hookmanager(name("approve"), get_self() );
+  hookmanager(name("approvemany") );
 }
 
 /**
@@ -174,7 +171,7 @@ ACTION daclifycore::approve(name approver, uint64_t id) {
  * @param description A string that describes the off-chain activity.
  */
 ACTION daclifycore::offchain(const string&  description) {
-  hookmanager(name("offchain"), get_self() );
+  hookmanager(name("offchain") );
 }
 
 /**
@@ -187,28 +184,30 @@ ACTION daclifycore::offchain(const string&  description) {
  */
 ACTION daclifycore::unapprove(name unapprover, uint64_t id) {
   require_auth(unapprover);
+  require_upgraded();
   check(is_custodian(unapprover, true, true), "You can't unapprove because you are not a custodian.");
-  proposals_table _proposals(get_self(), get_self().value);
-  auto prop_itr = _proposals.find(id);
-  check(prop_itr != _proposals.end(), "Proposal not found.");
+  unapprove_proposal(id, _custodians.get(unapprover.value) );
+  hookmanager(name("unapprove"), id);
+}
 
-  std::set<name> new_approvals{};
-  bool has_approved = false;
-  for (name old_approver: prop_itr->approvals) {
-    //check for dups and clean out non/old custodians.
-    if(old_approver == unapprover ){
-      has_approved = true;
-    }
-    else if(is_custodian(old_approver, false, false) ){
-      new_approvals.insert(old_approver);
-    }
+/**
+ * unapprovmany action withdraws the approval from a batch of proposals
+ * 
+ * @pre requires the authority of the unapprover
+ * 
+ * @param unapprover The account that is unapproving the proposals.
+ * @param ids The proposal ids.
+ */
+ACTION daclifycore::unapprovmany(name unapprover, vector<uint64_t> ids) {
+  require_auth(unapprover);
+  require_upgraded();
+  check(ids.size() > 0, "No proposal ids.");
+  check(is_custodian(unapprover, true, true), "You can't unapprove because you are not a custodian.");
+  const custodians& cust = _custodians.get(unapprover.value);
+  for(uint64_t id : ids){
+    unapprove_proposal(id, cust);
   }
-  check(has_approved, "You are not in the list of approvals.");
-  _proposals.modify( prop_itr, same_payer, [&]( auto& n) {
-      n.approvals = vector<name>(new_approvals.begin(), new_approvals.end() );
-      n.last_actor = unapprover;
-  });
-  hookmanager(name("unapprove"), get_self() );
+  hookmanager(name("unapprovmany") );
 }
 
 
@@ -223,9 +222,8 @@ ACTION daclifycore::unapprove(name unapprover, uint64_t id) {
  * @param id the proposal id
  */
 ACTION daclifycore::cancel(name canceler, uint64_t id) {
-
+  require_upgraded();
   
-  proposals_table _proposals(get_self(), get_self().value);
   auto prop_itr = _proposals.find(id);
   check(prop_itr != _proposals.end(), "Proposal not found.");
 
@@ -241,7 +239,7 @@ ACTION daclifycore::cancel(name canceler, uint64_t id) {
   });
   archive_proposal(name("cancelled"), _proposals, prop_itr);
   is_custodian(canceler, true, true);//this will update the timestamp if canceler is (still) custodian
-  hookmanager(name("cancel"), get_self() );
+  hookmanager(name("cancel"), id);
 }
 
 /**
@@ -255,7 +253,7 @@ ACTION daclifycore::cancel(name canceler, uint64_t id) {
  */
 ACTION daclifycore::exec(name executer, uint64_t id) {
   require_auth(executer);
-  proposals_table _proposals(get_self(), get_self().value);
+  require_upgraded();
   auto prop_itr = _proposals.find(id);
   check(prop_itr != _proposals.end(), "Proposal not found.");
   time_point_sec now = time_point_sec(current_time_point());
@@ -263,26 +261,78 @@ ACTION daclifycore::exec(name executer, uint64_t id) {
   check( now < prop_itr->expiration, "Proposal Expired.");
 
   //verify if can be executed -> highest threshold met?
-  uint8_t total_approved_weight = get_total_approved_proposal_weight(prop_itr);
-
-  uint8_t highest_action_threshold = get_threshold_by_name(prop_itr->required_threshold);
+  uint8_t total_approved_weight = get_approved_weight(prop_itr);
+  uint8_t highest_action_threshold = get_proposal_threshold(*prop_itr);
   
   check(total_approved_weight >= highest_action_threshold, "Not enough vote weight for execution.");
 
-  //exec
-  for(action act : prop_itr->actions) { 
-      act.send();
-  }
-
   _proposals.modify( prop_itr, same_payer, [&]( auto& n) {
       n.last_actor = executer;
   });
 
-  archive_proposal(name("executed"), _proposals, prop_itr);
+  //exec
+  execute_proposal(prop_itr);
   //_proposals.erase(prop_itr);
 
   is_custodian(executer, true, true);//this will update the timestamp if canceler is (still) custodian
-  hookmanager(name("exec"), get_self() );
+  hookmanager(name("exec"), id);
+}
+
+/**
+ * execsigned action executes actions that are signed by enough custodians in the same transaction. The
+ * approvals are tallied from the signatures so no proposal row is written, only the archive ring is
+ * updated when proposal_archive_size > 0.
+ * 
+ * @pre requires the authority of all approvers
+ * 
+ * @param approvers The custodians that sign the transaction.
+ * @param actions The actions to execute.
+ */
+ACTION daclifycore::execsigned(vector<name> approvers, vector<action> actions) {
+  check(approvers.size() > 0, "No approvers.");
+  require_upgraded();
+
+  threshold_name_and_value max_required_threshold = get_max_required_threshold(actions);
+
+  time_point_sec now = time_point_sec(current_time_point() );
+  uint64_t approvals = 0;
+  uint8_t approved_weight = 0;
+  for(const name& approver : approvers){
+    check(has_auth(approver), "Missing authority of "+approver.to_string()+".");
+    auto cust_itr = _custodians.find(approver.value);
+    check(cust_itr != _custodians.end(), approver.to_string()+" is not a custodian.");
+    check(is_account_alive(cust_itr->inactive_after), approver.to_string()+" has been inactive and must verify being alive first.");
+    uint64_t approver_bit = uint64_t(1) << cust_itr->slot;
+    check(!(approvals & approver_bit), "Duplicate approver "+approver.to_string()+".");
+    approvals |= approver_bit;
+    approved_weight += cust_itr->weight;
+    _custodians.modify( cust_itr, same_payer, [&]( auto& a) {
+        a.last_active = now;
+        a.inactive_after = get_inactive_deadline(a.last_active);
+    });
+  }
+
+  check(approved_weight >= max_required_threshold.threshold, "Not enough vote weight for execution.");
+
+  send_proposal_actions(actions);
+
+  if(get_group_conf().proposal_archive_size > 0){
+    //signed executions have no proposal id, the archive row is identified by its trx_id
+    proposals prop;
+    prop.id = UINT64_MAX;
+    prop.proposer = approvers[0];
+    prop.submitted = now;
+    prop.expiration = now;
+    prop.approvals = approvals;
+    prop.tally_epoch = get_group_state().cust_epoch;
+    prop.last_actor = approvers[0];
+    propbodies body;
+    body.actions = actions;
+    body.trx_id = get_trx_id();
+    write_archive_row(name("executed"), prop, &body);
+  }
+
+  hookmanager(name("execsigned") );
 }
 
 /**
@@ -294,6 +344,7 @@ ACTION daclifycore::exec(name executer, uint64_t id) {
  */
 ACTION daclifycore::invitecust(name account){
   require_auth(get_self() );
+  require_upgraded();
   check(account != get_self(), "Self can't be a custodian.");
 
   //don't allow invitation of custodians when election module is installed
@@ -303,34 +354,38 @@ ACTION daclifycore::invitecust(name account){
 
   check(is_account_voice_wrapper(account), "Account does not exist or doesn't meet requirements.");
 
-  custodians_table _custodians(get_self(), get_self().value);
   auto cust_itr = _custodians.find(account.value);
 
   check(cust_itr == _custodians.end(), "Account already a custodian.");
 
-  corestate_table _corestate(get_self(), get_self().value);
-  auto state = _corestate.get_or_create(get_self(), corestate());
-
   //time_point_sec last_active = state.state.cust_count==0 ? time_point_sec(current_time_point() ) : time_point_sec(0);
 
-  if(state.state.cust_count==0){
+  //the slot is assigned in the new epoch so approvals of a previous slot holder don't carry over
+  invalidate_approval_tallies();
+  uint8_t slot = assign_custodian_slot();
+
+  if(get_group_state().cust_count==0){
     _custodians.emplace( get_self(), [&]( auto& n){
         n.account = account;
         n.last_active = time_point_sec(current_time_point() );
+        n.inactive_after = get_inactive_deadline(n.last_active);
+        n.slot = slot;
+        n.slot_epoch = get_group_state().cust_epoch;
     });
-    state.state.cust_count = state.state.cust_count + 1;
-    _corestate.set(state, get_self());
+    update_custodian_count(1);
     update_active();
   
   }
   else{
     _custodians.emplace( get_self(), [&]( auto& n){
         n.account = account;
+        n.inactive_after = get_inactive_deadline(n.last_active);
+        n.slot = slot;
+        n.slot_epoch = get_group_state().cust_epoch;
     });
-    state.state.cust_count = state.state.cust_count + 1;
-    _corestate.set(state, get_self());
+    update_custodian_count(1);
   }
-  hookmanager(name("invitecust"), get_self() );
+  hookmanager(name("invitecust") );
 
 }
 
@@ -343,14 +398,16 @@ ACTION daclifycore::invitecust(name account){
  */
 ACTION daclifycore::removecust(name account){
   require_auth(get_self());
+  require_upgraded();
 
-  custodians_table _custodians(get_self(), get_self().value);
   auto cust_itr = _custodians.find(account.value);
 
   check(cust_itr != _custodians.end(), "Account is not a custodian.");
     
+  release_custodian_slot(cust_itr->slot);
   _custodians.erase(cust_itr);
   update_custodian_count(-1);
+  invalidate_approval_tallies();
   if(_custodians.begin() != _custodians.end() ){
     //the erased entry was not the last one.
     update_active();
@@ -358,7 +415,7 @@ ACTION daclifycore::removecust(name account){
   else{
     check(false, "Can't remove the last custodian.");
   }
-  hookmanager(name("removecust"), get_self() );
+  hookmanager(name("removecust") );
 }
 
 /**
@@ -370,17 +427,36 @@ ACTION daclifycore::removecust(name account){
  */
 ACTION daclifycore::imalive(name account){
   require_auth(account);
-  custodians_table _custodians(get_self(), get_self().value);
+  require_upgraded();
   auto cust_itr = _custodians.find(account.value);
   check(cust_itr != _custodians.end(), "You are not a custodian, no proof of live needed.");
-  if(!is_account_alive(cust_itr->last_active) ){
+  if(!is_account_alive(cust_itr->inactive_after) ){
     update_custodian_last_active(account);
     update_active();
   }
   else{
     update_custodian_last_active(account);
   }
-  hookmanager(name("imalive"), get_self() );
+  hookmanager(name("imalive") );
+}
+
+/**
+ * sweepinactive action drops inactive custodians from the active authority. Liveness deadlines follow the
+ * last_active order, so the custodian with the oldest last_active decides if anyone is inactive.
+ * Does nothing when nobody is inactive or the active authority is already current, so keepers can call
+ * it on a schedule.
+ */
+ACTION daclifycore::sweepinactive(){
+  require_upgraded();
+
+  auto by_last_active = _custodians.get_index<"bylastactive"_n>();
+  auto oldest = by_last_active.begin();
+  if(oldest == by_last_active.end() || is_account_alive(oldest->inactive_after) ){
+    return;
+  }
+  if(update_active() ){
+    hookmanager(name("sweepinactive") );
+  }
 }
 
 /**
@@ -391,61 +467,89 @@ ACTION daclifycore::imalive(name account){
 ACTION daclifycore::isetcusts(vector<name> accounts){
   
   //require_auth(get_self() );
-  modules_table _modules(get_self(), get_self().value);
-  auto itr = _modules.find(name("elections").value);
-  check(itr != _modules.end(), "Group doesn't have module elections");
+  const modules* elections = get_module(name("elections") );
+  check(elections != nullptr, "Group doesn't have module elections");
 
-  require_auth(itr->slave_permission.actor); //elections_contract
+  require_auth(elections->slave_permission.actor); //elections_contract
+  require_upgraded();
 
   int count_new = accounts.size();
-  auto conf = get_group_conf();
+  const groupconf& conf = get_group_conf();
   check(count_new <= conf.max_custodians, "Too many new custodians");
   check(count_new != 0, "Empty custodian list not allowed");
 
-  vector<custodians> new_custs;
-  custodians_table _custodians(get_self(), get_self().value);
-  
+  //merge-join the sorted new list against the custodians in primary key order
+  std::sort(accounts.begin(), accounts.end() );
+  check(std::adjacent_find(accounts.begin(), accounts.end() ) == accounts.end(), "Duplicate custodian in list");
+
+  vector<name> elected;
+  bool changed = false;
   time_point_sec now = time_point_sec(current_time_point().sec_since_epoch());
-  //this can be done more efficient->intersection
-  for(name cand : accounts){
-    //check if cand is already a custodian
-    auto itr_existing = _custodians.find(cand.value);
-    if(itr_existing != _custodians.end()){
-      new_custs.push_back(*itr_existing);
+  auto cust_itr = _custodians.begin();
+  auto cand_itr = accounts.begin();
+  while(cust_itr != _custodians.end() || cand_itr != accounts.end() ){
+    if(cand_itr == accounts.end() || (cust_itr != _custodians.end() && cust_itr->account < *cand_itr) ){
+      //departing custodian
+      release_custodian_slot(cust_itr->slot);
+      cust_itr = _custodians.erase(cust_itr);
+      changed = true;
+    }
+    else if(cust_itr == _custodians.end() || *cand_itr < cust_itr->account ){
+      //new custodian
+      elected.push_back(*cand_itr);
+      cand_itr++;
+      changed = true;
     }
     else{
-      custodians newelected{};
-      newelected.account = cand;
-      //newelected.weight = 1;
-      //newelected.authority = name("active");
-      //newelected.joined = time_point_sec(current_time_point().sec_since_epoch());
-      newelected.last_active = now;
-      new_custs.push_back(newelected);
+      //incumbent keeps its row
+      cust_itr++;
+      cand_itr++;
     }
   }
 
-  //empty current custodian table
-  auto clean_itr = _custodians.begin();
-  while(clean_itr != _custodians.end() ) {
-    clean_itr = _custodians.erase(clean_itr);
+  //re-electing the same council keeps the approvals of open proposals and the active authority valid
+  if(changed){
+    //new custodians get a free slot in the new epoch
+    invalidate_approval_tallies();
+    for(name cand : elected){
+      uint8_t slot = assign_custodian_slot();
+      _custodians.emplace( get_self(), [&]( auto& n){
+          n.account = cand;
+          n.last_active = now;
+          n.inactive_after = get_inactive_deadline(now);
+          n.slot = slot;
+          n.slot_epoch = get_group_state().cust_epoch;
+      });
+    }
+    update_active();
+    modify_group_state().cust_count = count_new;
   }
 
-  //repopulate with new elected
-  for(custodians nc : new_custs){
-    _custodians.emplace( get_self(), [&]( auto& n){
-        n = nc;
-    });
-  }
+  hookmanager(name("isetcusts") );
 
-  update_active();
+}
 
-  corestate_table _corestate(get_self(), get_self().value);
-  auto state = _corestate.get_or_create(get_self(), corestate());
-  state.state.cust_count = count_new;
-  _corestate.set(state, get_self());
+/**
+ * This function is called by the hooks module to register the actions that have a hook.
+ * Actions that are not in the list skip the hook lookup entirely.
+ * 
+ * @param hooked_actions the names of the core actions that have a hook
+ */
+ACTION daclifycore::isethooks(vector<name> hooked_actions){
+  const modules* hooks = get_module(name("hooks") );
+  check(hooks != nullptr, "Group doesn't have module hooks");
 
-  hookmanager(name("isetcusts"), get_self() );
+  require_auth(hooks->slave_permission.actor); //hooks_contract
 
+  std::sort(hooked_actions.begin(), hooked_actions.end() );
+  hooked_actions.erase(std::unique(hooked_actions.begin(), hooked_actions.end() ), hooked_actions.end() );
+  if(hooked_actions.size() == 0){
+    _hookreg.remove();
+  }
+  else{
+    _hookreg.set(hookreg{hooked_actions}, get_self() );
+  }
+  _hooked_actions = hooked_actions;
 }
 
 /**
@@ -464,15 +568,16 @@ ACTION daclifycore::widthdraw(name account, extended_asset amount) {
   check(get_group_conf().withdrawals, "Withdrawals are disabled");
   check(account != get_self(), "Can't withdraw to self.");
   check(amount.quantity.amount > 0, "Amount must be greater then zero.");
+  settle_stream(account);
 
   //sub_balance(account, amount); this is handled by the on_notify !!!
   
-  action(
+  send_action(action(
     permission_level{get_self(), "owner"_n},
     amount.contract, "transfer"_n,
     make_tuple(get_self(), account, amount.quantity, string("withdraw from user account"))
-  ).send();
-  hookmanager(name("widthdraw"), get_self() );
+  ) );
+  hookmanager(name("widthdraw") );
 }
 
 /**
@@ -492,9 +597,195 @@ ACTION daclifycore::internalxfr(name from, name to, extended_asset amount, strin
   check(is_member(from), "Sender must be a member." );
   check(is_member(to), "Receiver must be a member." );
   check(amount.quantity.amount > 0, "Transfer value must be greater then zero.");
+  settle_stream(from);
   sub_balance(from, amount);
   add_balance(to, amount);
-  hookmanager(name("internalxfr"), get_self() );
+  hookmanager(name("internalxfr") );
+}
+
+/**
+ * internalxfrs action allows members to transfer tokens to many members at once. Membership is checked
+ * once per receiver and the transfers are netted per account and token, so every balance row is
+ * read and written once.
+ * 
+ * @pre requires the authority of the 'from' account
+ * 
+ * @param from The account that is sending the funds.
+ * @param transfers The receivers, amounts and memos.
+ */
+ACTION daclifycore::internalxfrs(name from, vector<transfer> transfers){
+  require_auth(from);
+  check(get_group_conf().internal_transfers, "Internal transfers are disabled.");
+  check(transfers.size() > 0, "No transfers.");
+  check(is_member(from), "Sender must be a member." );
+  settle_stream(from);
+
+  //net deltas keyed by account and contract/symbol
+  std::map<std::pair<uint64_t, uint128_t>, extended_asset> deltas;
+  std::set<uint64_t> receivers;
+  for(const transfer& t : transfers){
+    check(t.to != from, "Can't transfer to self.");
+    check(t.amount.quantity.is_valid(), "Invalid transfer value.");
+    check(t.amount.quantity.amount > 0, "Transfer value must be greater then zero.");
+    if(receivers.insert(t.to.value).second){
+      check(is_member(t.to), "Receiver "+t.to.to_string()+" must be a member." );
+    }
+    uint128_t contr_sym = (uint128_t{t.amount.contract.value} << 64) | t.amount.quantity.symbol.raw();
+    auto debit = deltas.emplace(std::make_pair(from.value, contr_sym), extended_asset(0, t.amount.get_extended_symbol() ) ).first;
+    debit->second += t.amount;
+    auto credit = deltas.emplace(std::make_pair(t.to.value, contr_sym), extended_asset(0, t.amount.get_extended_symbol() ) ).first;
+    credit->second += t.amount;
+  }
+
+  //debits first so an overdrawn sender fails before any receiver row is touched
+  for(const auto& delta : deltas){
+    if(delta.first.first == from.value){
+      sub_balance(from, delta.second);
+    }
+  }
+  for(const auto& delta : deltas){
+    if(delta.first.first != from.value){
+      add_balance(name(delta.first.first), delta.second);
+    }
+  }
+  hookmanager(name("internalxfrs") );
+}
+
+/**
+ * migratebals action moves the legacy balances rows into the primary keyed tokenbals table, the group
+ * scope first and then the member scopes. Resumable, every call continues at the stored cursor.
+ * 
+ * @pre requires the authority of the core contract
+ * 
+ * @param max_scopes The maximum number of scopes to migrate in this call.
+ */
+ACTION daclifycore::migratebals(uint32_t max_scopes){
+  require_auth(get_self() );
+  check(max_scopes > 0, "max_scopes must be greater than zero.");
+  check(!get_group_state().balances_migrated, "Balances are already migrated.");
+
+  fullstate& state = modify_group_state();
+  uint32_t migrated = 0;
+  if(state.balance_migration_cursor == 0){
+    migrate_balance_scope(get_self() );
+    state.balance_migration_cursor = 1;
+    migrated++;
+  }
+  auto mem_itr = _members.lower_bound(state.balance_migration_cursor);
+  while(migrated < max_scopes && mem_itr != _members.end() ){
+    migrate_balance_scope(mem_itr->account);
+    state.balance_migration_cursor = mem_itr->account.value + 1;
+    migrated++;
+    mem_itr++;
+  }
+  if(mem_itr == _members.end() ){
+    state.balances_migrated = true;
+  }
+}
+
+/**
+ * upgrade action converts the custodians and open proposals written by the first release into the current
+ * layout. Custodians get a slot in the approvals bitmap, open proposals are split into header and body
+ * with their approvals mapped onto the slots. The hook registry is seeded from the actionhooks table of
+ * the hooks module. Resumable, every call continues at the stored cursor.
+ * Push it in the same transaction as the code update, custodian and proposal actions fail until it's done.
+ * 
+ * @pre requires the authority of the core contract
+ * 
+ * @param max_rows The maximum number of open proposals to convert in this call.
+ */
+ACTION daclifycore::upgrade(uint32_t max_rows){
+  require_auth(get_self() );
+  check(max_rows > 0, "max_rows must be greater then zero.");
+  check(!get_group_state().upgraded, "Group data is already upgraded.");
+
+  fullstate& state = modify_group_state();
+  if(!state.custodians_upgraded){
+    legacycusts_table _legacycusts(get_self(), get_self().value);
+    vector<legacycusts> legacy_custs;
+    auto cust_itr = _legacycusts.begin();
+    while(cust_itr != _legacycusts.end() ){
+      legacy_custs.push_back(*cust_itr);
+      cust_itr = _legacycusts.erase(cust_itr);
+    }
+    for(const legacycusts& legacy : legacy_custs){
+      uint8_t slot = assign_custodian_slot();
+      _custodians.emplace( get_self(), [&]( auto& n){
+          n.account = legacy.account;
+          n.authority = legacy.authority;
+          n.weight = legacy.weight;
+          n.joined = legacy.joined;
+          n.last_active = legacy.last_active;
+          n.inactive_after = get_inactive_deadline(legacy.last_active);
+          n.slot = slot;
+          n.slot_epoch = state.cust_epoch;
+      });
+    }
+
+    //hooks of the first release live only in the hooks module, the local registry is seeded from it
+    const modules* hooks_module = get_module(name("hooks") );
+    if(hooks_module != nullptr && !_hookreg.exists() ){
+      name hooks_contract = hooks_module->slave_permission.actor;
+      actionhooks_table _actionhooks(hooks_contract, hooks_contract.value);
+      vector<name> hooked_actions;
+      for(const actionhooks& hook : _actionhooks){
+        if(hook.hooked_contract == get_self() ){
+          hooked_actions.push_back(hook.hooked_action);
+        }
+      }
+      std::sort(hooked_actions.begin(), hooked_actions.end() );
+      hooked_actions.erase(std::unique(hooked_actions.begin(), hooked_actions.end() ), hooked_actions.end() );
+      if(hooked_actions.size() != 0){
+        _hookreg.set(hookreg{hooked_actions}, get_self() );
+      }
+    }
+    state.custodians_upgraded = true;
+  }
+
+  legacyprops_table _legacyprops(get_self(), get_self().value);
+  auto prop_itr = _legacyprops.lower_bound(state.upgrade_cursor);
+  uint32_t counter = 0;
+  while(prop_itr != _legacyprops.end() && counter++ < max_rows){
+    legacyprops legacy = *prop_itr;
+    prop_itr = _legacyprops.erase(prop_itr);
+
+    //approvals of accounts that are no longer custodian are dropped
+    uint64_t approvals = 0;
+    uint8_t approved_weight = 0;
+    for(const name& approver : legacy.approvals){
+      auto cust_itr = _custodians.find(approver.value);
+      if(cust_itr != _custodians.end() && !(approvals & (uint64_t(1) << cust_itr->slot) ) ){
+        approvals |= uint64_t(1) << cust_itr->slot;
+        approved_weight += cust_itr->weight;
+      }
+    }
+    uint8_t threshold = get_threshold_by_name(legacy.required_threshold);
+
+    _propbodies.emplace(get_self(), [&](auto& n) {
+      n.id = legacy.id;
+      n.title = legacy.title;
+      n.description = legacy.description;
+      n.actions = legacy.actions;
+      n.trx_id = legacy.trx_id;
+    });
+    _proposals.emplace(get_self(), [&](auto& n) {
+      n.id = legacy.id;
+      n.proposer = legacy.proposer;
+      n.submitted = legacy.submitted;
+      n.expiration = legacy.expiration;
+      n.approvals = approvals;
+      n.required_threshold = legacy.required_threshold;
+      n.last_actor = legacy.last_actor;
+      n.approved_weight = approved_weight;
+      n.tally_epoch = state.cust_epoch;
+      n.required_threshold_value = threshold;
+      n.policy_version = state.policy_version;
+    });
+    state.upgrade_cursor = legacy.id + 1;
+  }
+  if(prop_itr == _legacyprops.end() ){
+    state.upgraded = true;
+  }
 }
 
 /**
@@ -536,7 +827,6 @@ ACTION daclifycore::manthreshlin(name contract, name action_name, name threshold
   }
   check(is_existing_threshold_name(threshold_name), "Threshold name doesn't exist. Create it first.");
 
-  threshlinks_table _threshlinks(get_self(), get_self().value);
 
   auto by_cont_act = _threshlinks.get_index<"bycontact"_n>();
   uint128_t composite_id = (uint128_t{contract.value} << 64) | action_name.value;
@@ -560,10 +850,13 @@ ACTION daclifycore::manthreshlin(name contract, name action_name, name threshold
       n.threshold_name = threshold_name;
     });
   }
+  _policy_dirty = true;
 }
 
 /**
- * trunchistory action deletes the oldest proposals from the history table
+ * trunchistory action deletes the archived proposals in slots outside the archive ring, and the full
+ * proposals rows the first release archived in the same scope.
+ * Archiving keeps the history bounded by itself, this is for manual cleanup after lowering proposal_archive_size
  * 
  * @pre requires the authority of the core contract
  * 
@@ -573,14 +866,34 @@ ACTION daclifycore::manthreshlin(name contract, name action_name, name threshold
 ACTION daclifycore::trunchistory( name archive_type, uint32_t batch_size){
   require_auth(get_self() );
   check(archive_type != get_self(), "Not allowed to clear this scope.");
-  proposals_table h_proposals(get_self(), archive_type.value);
-  check(h_proposals.begin() != h_proposals.end(), "History scope empty.");
 
   uint32_t counter = 0;
-  auto itr = h_proposals.begin();
-  while(itr != h_proposals.end() && counter++ < batch_size) {
-    itr = h_proposals.erase(itr);
+  legacyprops_table _legacyarchive(get_self(), archive_type.value);
+  auto legacy_itr = _legacyarchive.begin();
+  while(legacy_itr != _legacyarchive.end() && counter < batch_size) {
+    legacy_itr = _legacyarchive.erase(legacy_itr);
+    counter++;
+  }
+
+  proparchive_table _proparchive(get_self(), archive_type.value);
+  auto itr = _proparchive.lower_bound(get_group_conf().proposal_archive_size);
+  while(itr != _proparchive.end() && counter < batch_size) {
+    itr = _proparchive.erase(itr);
+    counter++;
   }
+  check(counter > 0, "No archived proposals outside the archive ring.");
+}
+
+/**
+ * purgeexpired action archives proposals that expired without being executed or cancelled
+ * 
+ * @param max_rows The maximum number of proposals to archive in this call.
+ */
+ACTION daclifycore::purgeexpired(uint32_t max_rows){
+  check(max_rows > 0, "max_rows must be greater then zero.");
+  require_upgraded();
+  check(purge_expired_proposals(max_rows) > 0, "No expired proposals.");
+  hookmanager(name("purgeexpired") );
 }
 
 /**
@@ -596,7 +909,6 @@ ACTION daclifycore::regmember(name actor){
   check(conf.member_registration, "Member registration is disabled.");
   check(is_account_voice_wrapper(actor), "Accountname not eligible for registering as member.");
   check(actor != get_self(), "Contract can't be a member of itself.");
-  members_table _members(get_self(), get_self().value);
   auto mem_itr = _members.find(actor.value);
   check(mem_itr == _members.end(), "Accountname already a member.");
 
@@ -605,7 +917,66 @@ ACTION daclifycore::regmember(name actor){
     n.member_since = time_point_sec(current_time_point() );
   });
   update_member_count(1);
-  hookmanager(name("regmember"), get_self() );
+  hookmanager(name("regmember") );
+}
+
+/**
+ * regmembers action registers a batch of accounts as members, the member count is updated once.
+ * Accounts that are already a member are skipped.
+ * 
+ * @pre requires the authority of the core contract
+ * 
+ * @param accounts The accounts to register.
+ */
+ACTION daclifycore::regmembers(vector<name> accounts){
+  require_auth(get_self() );
+  check(accounts.size() > 0, "No accounts.");
+
+  time_point_sec now = time_point_sec(current_time_point() );
+  int added = 0;
+  for(const name& account : accounts){
+    check(account != get_self(), "Contract can't be a member of itself.");
+    if(_members.find(account.value) != _members.end() ){
+      continue;
+    }
+    check(is_account_voice_wrapper(account), "Accountname not eligible for registering as member.");
+    _members.emplace( get_self(), [&]( auto& n){
+      n.account = account;
+      n.member_since = now;
+    });
+    added++;
+  }
+  if(added > 0){
+    update_member_count(added);
+  }
+  hookmanager(name("regmembers") );
+}
+
+/**
+ * unregmembers action removes a batch of members, the member count is updated once. Accounts that are
+ * not a member, still have a balance or a pay stream are skipped.
+ * 
+ * @pre requires the authority of the core contract
+ * 
+ * @param accounts The members to remove.
+ */
+ACTION daclifycore::unregmembers(vector<name> accounts){
+  require_auth(get_self() );
+  check(accounts.size() > 0, "No accounts.");
+
+  int removed = 0;
+  for(const name& account : accounts){
+    auto mem_itr = _members.find(account.value);
+    if(mem_itr == _members.end() || member_has_balance(account) || _paystreams.find(account.value) != _paystreams.end() ){
+      continue;
+    }
+    _members.erase(mem_itr);
+    removed++;
+  }
+  if(removed > 0){
+    update_member_count(-removed);
+  }
+  hookmanager(name("unregmembers") );
 }
 
 /**
@@ -621,7 +992,6 @@ ACTION daclifycore::signuserterm(name member, bool agree_terms){
   groupconf conf = get_group_conf();
   check(conf.userterms, "Userterms disabled.");
 
-  members_table _members(get_self(), get_self().value);
   auto mem_itr = _members.find(member.value);
   check(mem_itr != _members.end(), "Must register before signing the userterms.");
 
@@ -644,7 +1014,7 @@ ACTION daclifycore::signuserterm(name member, bool agree_terms){
   _members.modify( mem_itr, same_payer, [&]( auto& n) {
       n.agreed_userterms_version = updated_agreed_version;
   });  
-  hookmanager(name("signuserterm"), get_self() );
+  hookmanager(name("signuserterm") );
 
 }
 
@@ -659,12 +1029,12 @@ ACTION daclifycore::signuserterm(name member, bool agree_terms){
 ACTION daclifycore::unregmember(name actor){
   require_auth(actor);
   check(!member_has_balance(actor),"Member has positive balance, withdraw first.");
-  members_table _members(get_self(), get_self().value);
+  check(_paystreams.find(actor.value) == _paystreams.end(), "Member has a pay stream, it must be removed first.");
   auto mem_itr = _members.find(actor.value);
   check(mem_itr != _members.end(), "Accountname is not a member.");
   _members.erase(mem_itr);
   update_member_count(-1);
-  hookmanager(name("unregmember"), get_self() );
+  hookmanager(name("unregmember") );
 }
 
 /**
@@ -760,7 +1130,6 @@ ACTION daclifycore::delprofile(name actor){
  */
 ACTION daclifycore::linkmodule(name module_name, permission_level slave_permission, bool has_contract){
   require_auth(get_self() );
-  modules_table _modules(get_self(), get_self().value);
   auto itr = _modules.find(module_name.value);
   check(module_name.value != 0, "Module name must be specified");
   check(itr == _modules.end(), "Duplicate module name.");
@@ -774,7 +1143,8 @@ ACTION daclifycore::linkmodule(name module_name, permission_level slave_permissi
       n.slave_permission = slave_permission;
       n.has_contract = has_contract;
   });
-  hookmanager(name("linkmodule"), get_self() );
+  forget_module(module_name);
+  hookmanager(name("linkmodule") );
 }
 
 /**
@@ -786,11 +1156,15 @@ ACTION daclifycore::linkmodule(name module_name, permission_level slave_permissi
  */
 ACTION daclifycore::unlinkmodule(name module_name){
   require_auth(get_self() );
-  modules_table _modules(get_self(), get_self().value);
   auto itr = _modules.find(module_name.value);
   check(itr != _modules.end(), "Module doesn't exists.");
   _modules.erase(itr);
-  hookmanager(name("unlinkmodule"), get_self() );
+  forget_module(module_name);
+  if(module_name == name("hooks") ){
+    _hookreg.remove();
+    _hooked_actions.reset();
+  }
+  hookmanager(name("unlinkmodule") );
 }
 
 /**
@@ -854,18 +1228,19 @@ ACTION daclifycore::ipayroll(
                     ){
 
   /* all modules are allowed to call the payroll interface */
-  modules_table _modules(get_self(), get_self().value);
-  auto payroll_module = _modules.get(name("payroll").value, "payroll module not available");
-  auto module_sender = _modules.get(sender_module_name.value, "Module that tries to use the payroll interface doesn't exist.");
-  require_auth(module_sender.slave_permission.actor);
+  const modules* payroll_module = get_module(name("payroll") );
+  check(payroll_module != nullptr, "payroll module not available");
+  const modules* module_sender = get_module(sender_module_name);
+  check(module_sender != nullptr, "Module that tries to use the payroll interface doesn't exist.");
+  require_auth(module_sender->slave_permission.actor);
 
   //only allow inline calls
   //check(get_sender() == module_sender.slave_permission.actor, "Only inline calls allowed");
 
   //name payroll_tag, vector<payment> payments, time_point_sec due_date, uint8_t repeat, uint64_t recurrence_sec, bool auto_pay
-  action(
-    payroll_module.slave_permission,
-    payroll_module.slave_permission.actor,
+  send_action(action(
+    payroll_module->slave_permission,
+    payroll_module->slave_permission.actor,
     "addmany"_n,
     std::make_tuple(
       payroll_tag,
@@ -876,7 +1251,7 @@ ACTION daclifycore::ipayroll(
       recurrence_sec,
       auto_pay
     )
-  ).send();
+  ) );
   
 }
 
@@ -920,7 +1295,7 @@ ACTION daclifycore::filepublish(name file_scope, string title, checksum256 trx_i
       n.block_num = block_num;
       n.published = time_point_sec(current_time_point());
   });
-  hookmanager(name("filepublish"), get_self() );
+  hookmanager(name("filepublish") );
 }
 
 /**
@@ -937,10 +1312,76 @@ ACTION daclifycore::filedelete(name file_scope, uint64_t id){
   auto itr = _dacfiles.find(id);
   check(itr != _dacfiles.end(), "can't find id "+to_string(id)+" in file scope "+file_scope.to_string() );
   _dacfiles.erase(itr);
-  hookmanager(name("filedelete"), get_self() );
+  hookmanager(name("filedelete") );
 }
 
 
+/**
+ * setpaystream action creates, changes or removes the pay stream of a member. The stream accrues from
+ * the group balance and is credited to the member balance on widthdraw, internalxfr(s) and on every
+ * change of the stream, there are no scheduled payments. A rate of zero stops the stream. Pay that the
+ * group balance can't cover when the terms change stays owed on the row and is credited once the group
+ * is funded, the row is only removed when nothing is owed.
+ * 
+ * @pre requires the authority of the core contract
+ * 
+ * @param account The member that is paid.
+ * @param rate The amount that accrues every period_sec.
+ * @param period_sec The length of the period in seconds.
+ * @param end The time the stream stops accruing, time_point_sec(0) for an open ended stream.
+ */
+ACTION daclifycore::setpaystream(name account, extended_asset rate, uint32_t period_sec, time_point_sec end){
+  require_auth(get_self() );
+  check(is_member(account), "Account must be a member.");
+  check(rate.quantity.is_valid() && rate.quantity.amount >= 0, "Invalid rate.");
+
+  time_point_sec now = time_point_sec(current_time_point() );
+  //close the running stream before the terms change, the uncovered part is carried
+  int64_t carried = settle_stream(account);
+  auto itr = _paystreams.find(account.value);
+  if(itr != _paystreams.end() ){
+    if(rate.quantity.amount == 0){
+      if(carried == 0){
+        _paystreams.erase(itr);
+      }
+      else{
+        _paystreams.modify(itr, same_payer, [&](auto& n) {
+          n.rate.quantity.amount = 0;
+          n.start = now;
+          n.end = now;
+          n.claimed = 0;
+          n.carried = carried;
+        });
+      }
+      hookmanager(name("setpaystream") );
+      return;
+    }
+    check(carried == 0 || rate.get_extended_symbol() == itr->rate.get_extended_symbol(), "Owed pay must be credited before the stream changes token.");
+  }
+  else{
+    check(rate.quantity.amount > 0, "Rate must be greater then zero.");
+  }
+  check(period_sec > 0, "Period must be greater then zero.");
+  check(end == time_point_sec(0) || end > now, "End must be in the future.");
+
+  auto stream = [&](auto& n) {
+    n.account = account;
+    n.rate = rate;
+    n.period_sec = period_sec;
+    n.start = now;
+    n.end = end;
+    n.claimed = 0;
+    n.carried = carried;
+  };
+  if(itr == _paystreams.end() ){
+    _paystreams.emplace(get_self(), stream);
+  }
+  else{
+    _paystreams.modify(itr, same_payer, stream);
+  }
+  hookmanager(name("setpaystream") );
+}
+
 /**
  * asset-transfer notification handler
  * 
@@ -961,17 +1402,24 @@ void daclifycore::on_transfer(name from, name to, asset quantity, string memo){
   check(to != from, "Invalid transfer.");
 
   extended_asset extended_quantity = extended_asset(quantity, get_first_receiver());
-  groupconf conf = get_group_conf();
+  const groupconf& conf = get_group_conf();
+  std::string_view args;
+  memoverb verb = parse_memo_verb(memo, args);
   //////////////////////
   //incomming transfers
   //////////////////////
   if (to == get_self() ) {
-    //check memo if it's a transfer to top up a user wallet
-    if(memo.substr(0, 21) == "add to user account: " ){
+    //check memo if it's a transfer to top up user wallets
+    if(verb == memoverb::deposit){
       check(conf.deposits, "Deposits to user accounts is disabled.");
-      string potentialaccountname = memo.length() >= 22 ? memo.substr(21, 12 ) : "";
-      check(is_member(name(potentialaccountname) ), "Receiver in memo is not a registered member.");
-      add_balance( name(potentialaccountname), extended_quantity);
+      name receiver = name(args.substr(0, 12) );
+      check(is_member(receiver), "Receiver in memo is not a registered member.");
+      add_balance( receiver, extended_quantity);
+      return;
+    }
+    else if(verb == memoverb::deposit_many){
+      check(conf.deposits, "Deposits to user accounts is disabled.");
+      deposit_many(args, extended_quantity);
       return;
     }
     else{
@@ -985,7 +1433,7 @@ void daclifycore::on_transfer(name from, name to, asset quantity, string memo){
   //////////////////////
   if (from == get_self() ) {
     //check memo if it is a user withrawal
-    if(memo.substr(0, 26) == "withdraw from user account" ){
+    if(verb == memoverb::withdraw){
       print("user withdraw");
       check(is_member(to), "To is not an regstered member.");
       sub_balance( to, extended_quantity);
@@ -1014,8 +1462,25 @@ ACTION daclifycore::clearbals(name scope){
   while(itr != _balances.end() ) {
       itr = _balances.erase(itr);
   }
+  tokenbals_table _tokenbals( get_self(), scope.value);
+  auto bal_itr = _tokenbals.begin();
+  while(bal_itr != _tokenbals.end() ) {
+      bal_itr = _tokenbals.erase(bal_itr);
+  }
 }
 
 
 
-
+#ifdef RESOURCE_STATS
+/**
+ * Starts the resource accounting of the incoming action.
+ * Called by the dispatcher eosio-cpp generates before it routes the action,
+ * so the tracked action name is taken from the dispatch itself.
+ *
+ * @return true to let the dispatcher continue.
+ */
+extern "C" bool pre_dispatch(name self, name original_receiver, name action){
+  resourcestats::begin(action);
+  return true;
+}
+#endif